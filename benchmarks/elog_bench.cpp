@@ -0,0 +1,289 @@
+/**
+ * Measures the legacy client APIs: log<> with and without entry() fields,
+ * the journal metadata written by elog<T>() and report<T>(), and commit().
+ *
+ * The commit benchmarks start a private dbus-daemon and serve a stub of the
+ * internal Manager interface on it, which only hands out entry IDs, so they
+ * measure the client's side of a commit and never reach the real logging
+ * service.
+ */
+#include "config.h"
+
+#include "xyz/openbmc_project/Logging/Internal/Manager/server.hpp"
+
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <phosphor-logging/elog-errors.hpp>
+#include <phosphor-logging/elog.hpp>
+#include <phosphor-logging/log.hpp>
+#include <sdbusplus/bus.hpp>
+#include <sdbusplus/server/object.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <thread>
+
+#include <benchmark/benchmark.h>
+
+namespace
+{
+
+using namespace phosphor::logging;
+using namespace example::xyz::openbmc_project::example::elog;
+
+using ManagerIface =
+    sdbusplus::server::xyz::openbmc_project::logging::internal::Manager;
+
+const char* path = "/var/lib/phosphor-logging/extensions/pels/logs";
+
+/** @brief A dbus-daemon private to the benchmark.
+ *
+ *  The process's default bus is pointed at it, so that commit() talks to it
+ *  rather than the system bus.
+ */
+class PrivateBus
+{
+  public:
+    PrivateBus()
+    {
+        int fds[2];
+        if (pipe2(fds, O_CLOEXEC) != 0)
+        {
+            return;
+        }
+
+        pid = fork();
+        if (pid == 0)
+        {
+            // dup2 clears O_CLOEXEC, so only stdout is left for the daemon.
+            dup2(fds[1], STDOUT_FILENO);
+            execlp("dbus-daemon", "dbus-daemon", "--session", "--nofork",
+                   "--print-address=1", nullptr);
+            _exit(127);
+        }
+        close(fds[1]);
+
+        std::string address;
+        char c;
+        while (pid > 0 && read(fds[0], &c, 1) == 1 && c != '\n')
+        {
+            address += c;
+        }
+        close(fds[0]);
+
+        if (!address.empty())
+        {
+            setenv("DBUS_SYSTEM_BUS_ADDRESS", address.c_str(), 1);
+            setenv("DBUS_STARTER_BUS_TYPE", "system", 1);
+            started = true;
+        }
+    }
+
+    ~PrivateBus()
+    {
+        if (pid > 0)
+        {
+            kill(pid, SIGTERM);
+            waitpid(pid, nullptr, 0);
+        }
+    }
+
+    PrivateBus(const PrivateBus&) = delete;
+    PrivateBus& operator=(const PrivateBus&) = delete;
+
+    bool running() const
+    {
+        return started;
+    }
+
+  private:
+    pid_t pid = -1;
+    bool started = false;
+};
+
+/** @brief The internal Manager interface, minus the event logs. */
+class StubManager : public sdbusplus::server::object_t<ManagerIface>
+{
+  public:
+    StubManager(sdbusplus::bus_t& bus, const char* objPath) :
+        sdbusplus::server::object_t<ManagerIface>(bus, objPath)
+    {}
+
+    uint32_t commit(uint64_t, std::string) override
+    {
+        return ++entryID;
+    }
+
+    uint32_t commitWithLvl(uint64_t, std::string, uint32_t) override
+    {
+        return ++entryID;
+    }
+
+  private:
+    uint32_t entryID = 0;
+};
+
+/** @brief Serves a StubManager on the private bus from its own thread. */
+class StubService
+{
+  public:
+    StubService() : thread([this] { run(); })
+    {
+        ready.wait(false);
+    }
+
+    ~StubService()
+    {
+        stopping = true;
+        thread.join();
+    }
+
+    StubService(const StubService&) = delete;
+    StubService& operator=(const StubService&) = delete;
+
+  private:
+    void run()
+    {
+        auto bus = sdbusplus::bus::new_bus();
+        StubManager manager(bus, OBJ_INTERNAL);
+        bus.request_name(BUSNAME_LOGGING);
+
+        ready = true;
+        ready.notify_one();
+
+        while (!stopping)
+        {
+            while (bus.process_discard())
+            {}
+            bus.wait(std::chrono::microseconds(10000));
+        }
+    }
+
+    std::atomic<bool> ready{false};
+    std::atomic<bool> stopping{false};
+    std::thread thread;
+};
+
+/** @brief Starts the private bus and stub service the first time a
+ *         benchmark needs them.
+ *
+ *  @return false if dbus-daemon couldn't be started.
+ */
+bool startStubService()
+{
+    static PrivateBus bus;
+    if (!bus.running())
+    {
+        return false;
+    }
+
+    static StubService service;
+    return true;
+}
+
+void BM_Log(benchmark::State& state)
+{
+    for (auto _ : state)
+    {
+        log<level::DEBUG>("Legacy message");
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+void BM_LogEntries(benchmark::State& state)
+{
+    for (auto _ : state)
+    {
+        log<level::DEBUG>("Legacy message", entry("ERRNUM=0x%.4X", 0x1234),
+                          entry("FILE_PATH=%s", path),
+                          entry("FILE_NAME=%s", "elog_bench.txt"),
+                          entry("DEV_ID=%u", 100));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+/** @brief Measures the metadata elog<T>() writes, and the throw. */
+void BM_Elog(benchmark::State& state)
+{
+    for (auto _ : state)
+    {
+        try
+        {
+            elog<TestErrorOne>(
+                TestErrorOne::ERRNUM(0x1234), TestErrorOne::FILE_PATH(path),
+                TestErrorOne::FILE_NAME("elog_bench.txt"),
+                TestErrorTwo::DEV_ADDR(0xDEADDEAD), TestErrorTwo::DEV_ID(100),
+                TestErrorTwo::DEV_NAME("elog bench"));
+        }
+        catch (const TestErrorOne&)
+        {}
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+void BM_Report(benchmark::State& state)
+{
+    if (!startStubService())
+    {
+        state.SkipWithError("Couldn't start dbus-daemon");
+        return;
+    }
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(report<TestErrorOne>(
+            TestErrorOne::ERRNUM(0x1234), TestErrorOne::FILE_PATH(path),
+            TestErrorOne::FILE_NAME("elog_bench.txt"),
+            TestErrorTwo::DEV_ADDR(0xDEADDEAD), TestErrorTwo::DEV_ID(100),
+            TestErrorTwo::DEV_NAME("elog bench")));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+void BM_Commit(benchmark::State& state)
+{
+    if (!startStubService())
+    {
+        state.SkipWithError("Couldn't start dbus-daemon");
+        return;
+    }
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(commit<TestErrorOne>());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+void BM_CommitWithLvl(benchmark::State& state)
+{
+    if (!startStubService())
+    {
+        state.SkipWithError("Couldn't start dbus-daemon");
+        return;
+    }
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(
+            commit<TestErrorOne>(Entry::Level::Informational));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+} // namespace
+
+BENCHMARK(BM_Log);
+BENCHMARK(BM_LogEntries);
+BENCHMARK(BM_Elog);
+BENCHMARK(BM_Report);
+BENCHMARK(BM_Commit);
+BENCHMARK(BM_CommitWithLvl);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,161 @@
+/**
+ * Measures how long it takes to find the metadata of a committed error
+ * in the journal as the journal grows.
+ *
+ * This writes to the real system journal, so it is meant to be run on a
+ * development system or BMC, not as part of CI.
+ */
+#include "journal_harvester.hpp"
+
+#include <systemd/sd-journal.h>
+
+#include <chrono>
+#include <random>
+#include <set>
+#include <string>
+#include <string_view>
+#include <thread>
+
+#include <benchmark/benchmark.h>
+
+using phosphor::logging::JournalHarvester;
+
+namespace
+{
+
+std::mt19937_64 rng{std::random_device{}()};
+
+/** @brief Add unrelated entries so the journal holds at least 'count' of
+ *         them beyond what was there when the benchmark started. */
+void fillJournal(size_t count)
+{
+    static size_t written = 0;
+    for (; written < count; ++written)
+    {
+        sd_journal_send("MESSAGE=harvest benchmark filler", "PRIORITY=7",
+                        "TRANSACTION_ID=%llu",
+                        static_cast<unsigned long long>(rng()), nullptr);
+    }
+}
+
+/** @brief Write the entry to be harvested and wait for journald to index
+ *         it.
+ *
+ *  @return The TRANSACTION_ID of the entry
+ */
+uint64_t writeTarget(JournalHarvester& harvester)
+{
+    auto id = rng();
+    sd_journal_send("MESSAGE=harvest benchmark target", "PRIORITY=7",
+                    "TRANSACTION_ID=%llu", static_cast<unsigned long long>(id),
+                    "BENCH_FIELD=value", nullptr);
+
+    for (int i = 0; i < 100; ++i)
+    {
+        std::set<std::string> metalist{"BENCH_FIELD"};
+        if (!harvester.harvest(id, metalist).empty())
+        {
+            break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+    return id;
+}
+
+/** @brief The previous approach of walking every entry from the end of
+ *         the journal, kept here for comparison. */
+std::vector<std::string> fullScan(uint64_t transactionId,
+                                  std::set<std::string>& metalist)
+{
+    static constexpr std::string_view var{"TRANSACTION_ID"};
+    std::vector<std::string> additionalData;
+    auto idStr = std::to_string(transactionId);
+
+    sd_journal* j = nullptr;
+    if (sd_journal_open(&j, SD_JOURNAL_LOCAL_ONLY) < 0)
+    {
+        return additionalData;
+    }
+
+    SD_JOURNAL_FOREACH_BACKWARDS(j)
+    {
+        const char* data = nullptr;
+        size_t length = 0;
+        if ((sd_journal_get_data(j, var.data(), (const void**)&data,
+                                 &length) < 0) ||
+            (length <= var.size() + 1) ||
+            (idStr.compare(0, idStr.size(), data + var.size() + 1,
+                           length - var.size() - 1) != 0))
+        {
+            continue;
+        }
+
+        for (auto i = metalist.cbegin(); i != metalist.cend();)
+        {
+            if (sd_journal_get_data(j, i->c_str(), (const void**)&data,
+                                    &length) < 0)
+            {
+                i++;
+                continue;
+            }
+            additionalData.emplace_back(data, length);
+            i = metalist.erase(i);
+        }
+        if (metalist.empty())
+        {
+            break;
+        }
+    }
+
+    sd_journal_close(j);
+    return additionalData;
+}
+
+void BM_Harvest(benchmark::State& state)
+{
+    JournalHarvester harvester;
+    fillJournal(state.range(0));
+    auto id = writeTarget(harvester);
+
+    for (auto _ : state)
+    {
+        std::set<std::string> metalist{"BENCH_FIELD", "_PID"};
+        benchmark::DoNotOptimize(harvester.harvest(id, metalist));
+    }
+}
+
+void BM_HarvestMissing(benchmark::State& state)
+{
+    // A commit whose metadata isn't in the journal at all is the worst
+    // case for the old full scan.
+    JournalHarvester harvester;
+    fillJournal(state.range(0));
+
+    for (auto _ : state)
+    {
+        std::set<std::string> metalist{"BENCH_FIELD", "_PID"};
+        benchmark::DoNotOptimize(harvester.harvest(rng(), metalist));
+    }
+}
+
+void BM_FullScan(benchmark::State& state)
+{
+    JournalHarvester harvester;
+    fillJournal(state.range(0));
+    auto id = writeTarget(harvester);
+
+    for (auto _ : state)
+    {
+        std::set<std::string> metalist{"BENCH_FIELD", "_PID"};
+        benchmark::DoNotOptimize(fullScan(id, metalist));
+    }
+}
+
+} // namespace
+
+// Ranges must be increasing since the journal is only ever added to.
+BENCHMARK(BM_Harvest)->Arg(1000)->Arg(10000)->Arg(100000);
+BENCHMARK(BM_HarvestMissing)->Arg(100000);
+BENCHMARK(BM_FullScan)->Arg(100000);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,201 @@
+/**
+ * Measures what an lg2 call costs, both when its level is below the
+ * process's threshold and when it is logged to the journal, along with how
+ * many heap allocations each call makes.
+ *
+ * bench-lg2-null-journal runs the same benchmarks with the journal calls
+ * replaced by no-ops, to measure only the library's own overhead.
+ */
+#include <phosphor-logging/lg2.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <string>
+
+#include <benchmark/benchmark.h>
+
+namespace
+{
+
+std::atomic<uint64_t> allocations{0};
+
+} // namespace
+
+// Count every heap allocation in the process so the benchmarks can report
+// how many each lg2 call makes.  These are kept out of line so the compiler
+// doesn't pair up the malloc and free itself and warn about a mismatch.
+[[gnu::noinline]] void* operator new(size_t size)
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1); p != nullptr)
+    {
+        return p;
+    }
+    throw std::bad_alloc{};
+}
+
+[[gnu::noinline]] void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+[[gnu::noinline]] void operator delete(void* p, size_t) noexcept
+{
+    std::free(p);
+}
+
+namespace
+{
+
+/** @brief Runs a logging call and reports calls/sec and allocations/call. */
+template <typename F>
+void measure(benchmark::State& state, lg2::level threshold, F&& f)
+{
+    lg2::set_threshold(threshold);
+    auto start = allocations.load();
+
+    for (auto _ : state)
+    {
+        f();
+    }
+
+    state.SetItemsProcessed(state.iterations());
+    state.counters["allocs"] = benchmark::Counter(
+        static_cast<double>(allocations.load() - start),
+        benchmark::Counter::kAvgIterations);
+}
+
+const std::string path = "/var/lib/phosphor-logging/extensions/pels/logs";
+const uint32_t id = 0x50000001;
+
+void BM_Disabled(benchmark::State& state)
+{
+    measure(state, lg2::level::info, [] { lg2::debug("Disabled message"); });
+}
+
+void BM_DisabledFields(benchmark::State& state)
+{
+    measure(state, lg2::level::info, [] {
+        lg2::debug("Disabled message {ID} {PATH}", "ID", lg2::hex, id, "PATH",
+                   path, "SIZE", 2048, "RETRY", true);
+    });
+}
+
+void BM_RateLimited(benchmark::State& state)
+{
+    using namespace std::chrono_literals;
+
+    // All but the first call in each hour are suppressed.
+    measure(state, lg2::level::debug, [] {
+        PHOSPHOR_LOG2_RATELIMITED(1, 1h, debug, "Rate limited message {ID}",
+                                  "ID", lg2::hex, id);
+    });
+}
+
+void BM_Enabled(benchmark::State& state)
+{
+    measure(state, lg2::level::debug, [] { lg2::debug("Enabled message"); });
+}
+
+void BM_EnabledFields(benchmark::State& state)
+{
+    measure(state, lg2::level::debug, [] {
+        lg2::debug("Enabled message {ID} {PATH}", "ID", lg2::hex, id, "PATH",
+                   path, "SIZE", 2048, "RETRY", true);
+    });
+}
+
+void BM_EnabledLargeValue(benchmark::State& state)
+{
+    // Too big for do_log's stack buffer, so this one has to allocate.
+    const std::string value(4096, 'x');
+
+    measure(state, lg2::level::debug, [&value] {
+        lg2::debug("Enabled message {VALUE}", "VALUE", value);
+    });
+}
+
+/** @brief Logs one value with a set of format flags. */
+template <typename F, typename V>
+void BM_Format(benchmark::State& state, F flags, V value)
+{
+    measure(state, lg2::level::debug,
+            [&] { lg2::debug("Value {VALUE}", "VALUE", flags, value); });
+}
+
+void BM_FormatFloat(benchmark::State& state)
+{
+    measure(state, lg2::level::debug,
+            [] { lg2::debug("Value {VALUE}", "VALUE", 3.14159); });
+}
+
+/** @brief Logs a message with 0, 4 or 16 fields, all holding the same value.
+ */
+template <typename V>
+void logFields(int64_t count, const V& v)
+{
+    switch (count)
+    {
+        case 0:
+            lg2::debug("Fields");
+            break;
+
+        case 4:
+            lg2::debug("Fields {F0} {F3}", "F0", v, "F1", v, "F2", v, "F3", v);
+            break;
+
+        case 16:
+            lg2::debug("Fields {F0} {F15}", "F0", v, "F1", v, "F2", v, "F3",
+                       v, "F4", v, "F5", v, "F6", v, "F7", v, "F8", v, "F9", v,
+                       "F10", v, "F11", v, "F12", v, "F13", v, "F14", v, "F15",
+                       v);
+            break;
+    }
+}
+
+/** @brief Logs a message with state.range(0) fields of one type. */
+template <typename V>
+void BM_Fields(benchmark::State& state, V value)
+{
+    measure(state, lg2::level::debug,
+            [&] { logFields(state.range(0), value); });
+}
+
+} // namespace
+
+BENCHMARK_CAPTURE(BM_Fields, signed, int64_t{-12345678})
+    ->Arg(0)
+    ->Arg(4)
+    ->Arg(16);
+BENCHMARK_CAPTURE(BM_Fields, unsigned, uint64_t{id})->Arg(0)->Arg(4)->Arg(16);
+BENCHMARK_CAPTURE(BM_Fields, floating, 3.14159)->Arg(0)->Arg(4)->Arg(16);
+BENCHMARK_CAPTURE(BM_Fields, bool, true)->Arg(0)->Arg(4)->Arg(16);
+BENCHMARK_CAPTURE(BM_Fields, string, path)->Arg(0)->Arg(4)->Arg(16);
+
+BENCHMARK_CAPTURE(BM_Format, dec, lg2::dec, id);
+BENCHMARK_CAPTURE(BM_Format, dec_signed, lg2::dec, -12345678);
+BENCHMARK_CAPTURE(BM_Format, hex, lg2::hex, id);
+BENCHMARK_CAPTURE(BM_Format, hex_field8, lg2::hex | lg2::field8, id & 0xff);
+BENCHMARK_CAPTURE(BM_Format, hex_field16, lg2::hex | lg2::field16,
+                  id & 0xffff);
+BENCHMARK_CAPTURE(BM_Format, hex_field32, lg2::hex | lg2::field32, id);
+BENCHMARK_CAPTURE(BM_Format, hex_field64, lg2::hex | lg2::field64,
+                  uint64_t{id});
+BENCHMARK_CAPTURE(BM_Format, bin, lg2::bin, uint64_t{id});
+BENCHMARK_CAPTURE(BM_Format, bin_field8, lg2::bin | lg2::field8, id & 0xff);
+BENCHMARK_CAPTURE(BM_Format, bin_field16, lg2::bin | lg2::field16,
+                  id & 0xffff);
+BENCHMARK_CAPTURE(BM_Format, bin_field32, lg2::bin | lg2::field32, id);
+BENCHMARK(BM_FormatFloat);
+
+BENCHMARK(BM_Disabled);
+BENCHMARK(BM_DisabledFields);
+BENCHMARK(BM_RateLimited);
+BENCHMARK(BM_Enabled);
+BENCHMARK(BM_EnabledFields);
+BENCHMARK(BM_EnabledLargeValue);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,211 @@
+/**
+ * Compares creating event logs one at a time with Create against creating
+ * them all at once with CreateBatch, both in process and over D-Bus, and
+ * times restoring persisted event logs at startup and deleting them all.
+ *
+ * The D-Bus benchmarks create real event logs on the running logging
+ * service, so like the rest of the benchmarks these are meant to be run on
+ * a development system or BMC, not as part of CI.
+ */
+#include "config.h"
+
+#include "log_manager.hpp"
+
+#include <sdbusplus/bus.hpp>
+
+#include <filesystem>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+const char* ERRLOG_PERSIST_PATH = "/tmp/bench-errors";
+const char* ERRLOG_STORE_PATH = "/tmp/bench-store";
+const char* EXTENSION_PERSIST_DIR = "/tmp/bench-extensions";
+
+// Skips the Logging.Settings lookup, which needs the settings service.
+const bool IS_UNIT_TEST = true;
+
+namespace
+{
+
+using namespace phosphor::logging;
+namespace fs = std::filesystem;
+
+constexpr auto createIface = "xyz.openbmc_project.Logging.Create";
+constexpr auto createBatchIface = "xyz.openbmc_project.Logging.CreateBatch";
+
+/** @brief Makes the events a FRU dropping out might report. */
+std::vector<BatchEvent> makeEvents(size_t count)
+{
+    std::vector<BatchEvent> events;
+    for (size_t i = 0; i < count; i++)
+    {
+        events.emplace_back(
+            "xyz.openbmc_project.Common.Error.InternalFailure",
+            Entry::Level::Error,
+            std::map<std::string, std::string>{
+                {"FRU", "/xyz/openbmc_project/inventory/system/chassis/fan0"},
+                {"INDEX", std::to_string(i)}});
+    }
+    return events;
+}
+
+/** @brief Checks if the logging service is there to take D-Bus calls. */
+bool serviceRunning(sdbusplus::bus_t& bus)
+{
+    try
+    {
+        auto method = bus.new_method_call(
+            "org.freedesktop.DBus", "/org/freedesktop/DBus",
+            "org.freedesktop.DBus", "GetNameOwner");
+        method.append(BUSNAME_LOGGING);
+        bus.call(method);
+        return true;
+    }
+    catch (const sdbusplus::exception_t&)
+    {
+        return false;
+    }
+}
+
+void BM_Create(benchmark::State& state)
+{
+    fs::create_directories(ERRLOG_PERSIST_PATH);
+    auto bus = sdbusplus::bus::new_default();
+    internal::Manager manager(bus, OBJ_INTERNAL);
+    auto events = makeEvents(state.range(0));
+
+    for (auto _ : state)
+    {
+        for (const auto& [message, severity, additionalData] : events)
+        {
+            manager.create(message, severity, additionalData);
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * events.size());
+    manager.eraseAll();
+}
+
+void BM_CreateBatch(benchmark::State& state)
+{
+    fs::create_directories(ERRLOG_PERSIST_PATH);
+    auto bus = sdbusplus::bus::new_default();
+    internal::Manager manager(bus, OBJ_INTERNAL);
+    auto events = makeEvents(state.range(0));
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(manager.createBatch(events));
+    }
+
+    state.SetItemsProcessed(state.iterations() * events.size());
+    manager.eraseAll();
+}
+
+void BM_DBusCreate(benchmark::State& state)
+{
+    auto bus = sdbusplus::bus::new_default();
+    if (!serviceRunning(bus))
+    {
+        state.SkipWithError("The logging service isn't running");
+        return;
+    }
+    auto events = makeEvents(state.range(0));
+
+    for (auto _ : state)
+    {
+        for (const auto& [message, severity, additionalData] : events)
+        {
+            auto method = bus.new_method_call(BUSNAME_LOGGING, OBJ_LOGGING,
+                                              createIface, "Create");
+            method.append(message, severity, additionalData);
+            bus.call_noreply(method);
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * events.size());
+}
+
+void BM_DBusCreateBatch(benchmark::State& state)
+{
+    auto bus = sdbusplus::bus::new_default();
+    if (!serviceRunning(bus))
+    {
+        state.SkipWithError("The logging service isn't running");
+        return;
+    }
+    auto events = makeEvents(state.range(0));
+
+    for (auto _ : state)
+    {
+        auto method = bus.new_method_call(BUSNAME_LOGGING, OBJ_LOGGING,
+                                          createBatchIface, "CreateBatch");
+        method.append(events);
+        auto reply = bus.call(method);
+
+        std::vector<uint32_t> ids;
+        reply.read(ids);
+        benchmark::DoNotOptimize(ids);
+    }
+
+    state.SetItemsProcessed(state.iterations() * events.size());
+}
+
+void BM_Restore(benchmark::State& state)
+{
+    fs::create_directories(ERRLOG_PERSIST_PATH);
+    auto bus = sdbusplus::bus::new_default();
+    {
+        internal::Manager manager(bus, OBJ_INTERNAL);
+        manager.restore();
+        manager.eraseAll();
+        manager.createBatch(makeEvents(state.range(0)));
+    }
+
+    for (auto _ : state)
+    {
+        internal::Manager manager(bus, OBJ_INTERNAL);
+        manager.restore();
+        benchmark::DoNotOptimize(manager.lastEntryID());
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+
+    internal::Manager manager(bus, OBJ_INTERNAL);
+    manager.restore();
+    manager.eraseAll();
+}
+
+void BM_EraseAll(benchmark::State& state)
+{
+    fs::create_directories(ERRLOG_PERSIST_PATH);
+    auto bus = sdbusplus::bus::new_default();
+    internal::Manager manager(bus, OBJ_INTERNAL);
+    auto events = makeEvents(state.range(0));
+
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        manager.createBatch(events);
+        manager.flushEntries();
+        state.ResumeTiming();
+
+        manager.eraseAll();
+    }
+
+    state.SetItemsProcessed(state.iterations() * events.size());
+}
+
+} // namespace
+
+BENCHMARK(BM_Create)->Arg(1)->Arg(10)->Arg(50);
+BENCHMARK(BM_CreateBatch)->Arg(1)->Arg(10)->Arg(50);
+BENCHMARK(BM_DBusCreate)->Arg(1)->Arg(10)->Arg(50);
+BENCHMARK(BM_DBusCreateBatch)->Arg(1)->Arg(10)->Arg(50);
+BENCHMARK(BM_Restore)->Arg(10)->Arg(100);
+BENCHMARK(BM_EraseAll)->Arg(10)->Arg(100);
+
+BENCHMARK_MAIN();
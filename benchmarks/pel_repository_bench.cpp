@@ -0,0 +1,264 @@
+/**
+ * Measures the OpenPower PEL Repository:
+ *  - looking up PELs by PEL ID and by OpenBMC log ID, with repositories of
+ *    3,000 and 30,000 minimal PELs of just a private and a user header.
+ *  - reading PELs back from their files, with PELs of the maximum size.
+ *
+ * The repositories are filled once, in temporary directories.
+ */
+#include "extensions/openpower-pels/repository.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+namespace
+{
+
+using namespace openpower::pels;
+namespace fs = std::filesystem;
+
+using pelID = Repository::LogID::Pel;
+using obmcID = Repository::LogID::Obmc;
+
+/** The first PEL ID used, like the BMC's own PELs. */
+constexpr uint32_t firstPELID = 0x50000001;
+
+/** The first OpenBMC log ID used. */
+constexpr uint32_t firstOBMCID = 1;
+
+/** The size of the minimal PELs. */
+constexpr size_t minPELSize = 72;
+
+/** The largest a PEL can be. */
+constexpr size_t maxPELSize = 16384;
+
+/** The number of PELs in the repository of maximum sized PELs. */
+constexpr size_t maxSizedPELs = 100;
+
+/** @brief Makes the data of a PEL with the IDs passed in.
+ *
+ *  PELs bigger than the minimum get a user data section to fill them out.
+ */
+std::vector<uint8_t> makePELData(uint32_t id, uint32_t obmcLogID,
+                                 size_t size = minPELSize)
+{
+    std::vector<uint8_t> data{
+        // Private header
+        'P', 'H', 0x00, 0x30, 0x01, 0x00, 0x00, 0x00,   // section header
+        0x20, 0x24, 0x01, 0x01, 0x00, 0x00, 0x00, 0x00, // create timestamp
+        0x20, 0x24, 0x01, 0x01, 0x00, 0x00, 0x00, 0x00, // commit timestamp
+        'O', 0x00, 0x00, 0x02,                          // creator, count
+        0x00, 0x00, 0x00, 0x00,                         // OpenBMC log ID
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // creator version
+        0x00, 0x00, 0x00, 0x00,                         // PLID
+        0x00, 0x00, 0x00, 0x00,                         // PEL ID
+
+        // User header
+        'U', 'H', 0x00, 0x18, 0x01, 0x00, 0x00, 0x00, // section header
+        0x10, 0x04, 0x20, 0x00,                       // subsys, scope, sev
+        0x00, 0x00, 0x00, 0x00, 0x03, 0x04,           // reserved, domain
+        0x80, 0xC0, 0x00, 0x00, 0x00, 0x00};          // action flags
+
+    auto setWord = [&data](size_t offset, uint32_t value) {
+        for (size_t i = 0; i < sizeof(value); ++i)
+        {
+            data[offset + i] = value >> (8 * (sizeof(value) - 1 - i));
+        }
+    };
+
+    setWord(28, obmcLogID);
+    setWord(40, id);
+    setWord(44, id);
+
+    if (size > minPELSize)
+    {
+        data[27] = 3; // section count
+        data.resize(size, 0xA5);
+
+        auto sectionSize = size - minPELSize;
+        std::array<uint8_t, 8> header{
+            'U', 'D', static_cast<uint8_t>(sectionSize >> 8),
+            static_cast<uint8_t>(sectionSize), 0x01, 0x00, 0x00, 0x00};
+        std::copy(header.begin(), header.end(), data.begin() + minPELSize);
+    }
+
+    return data;
+}
+
+/** @brief Repositories of the sizes benchmarked, in temporary directories
+ *         which are removed on exit. */
+class Repositories
+{
+  public:
+    Repositories() = default;
+    Repositories(const Repositories&) = delete;
+    Repositories& operator=(const Repositories&) = delete;
+
+    ~Repositories()
+    {
+        repos.clear();
+        for (const auto& dir : dirs)
+        {
+            std::error_code ec;
+            fs::remove_all(dir, ec);
+        }
+    }
+
+    /** @brief Returns a repository of count PELs of the size passed in,
+     *         filling it the first time. */
+    Repository& get(size_t count, size_t size)
+    {
+        if (auto repo = repos.find({count, size}); repo != repos.end())
+        {
+            return *repo->second;
+        }
+
+        char templ[] = "/tmp/pelrepobenchXXXXXX";
+        fs::path dir = mkdtemp(templ);
+        dirs.push_back(dir);
+
+        auto repo = std::make_unique<Repository>(dir, SIZE_MAX, SIZE_MAX);
+        for (size_t i = 0; i < count; ++i)
+        {
+            auto data = makePELData(firstPELID + i, firstOBMCID + i, size);
+            auto pel = std::make_unique<PEL>(data);
+            repo->add(pel);
+        }
+
+        return *repos.emplace(std::pair{count, size}, std::move(repo))
+                    .first->second;
+    }
+
+  private:
+    std::map<std::pair<size_t, size_t>, std::unique_ptr<Repository>> repos;
+    std::vector<fs::path> dirs;
+};
+
+Repository& getRepository(size_t count, size_t size = minPELSize)
+{
+    static Repositories repositories;
+    return repositories.get(count, size);
+}
+
+/** @brief Looks up every PEL in turn by PEL ID. */
+void BM_FindByPELID(benchmark::State& state)
+{
+    auto count = state.range(0);
+    auto& repo = getRepository(count);
+
+    uint32_t i = 0;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(
+            repo.getPELAttributes(Repository::LogID{pelID{firstPELID + i}}));
+        i = (i + 1) % count;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+/** @brief Looks up every PEL in turn by OpenBMC log ID. */
+void BM_FindByOBMCID(benchmark::State& state)
+{
+    auto count = state.range(0);
+    auto& repo = getRepository(count);
+
+    uint32_t i = 0;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(repo.getLogID(
+            Repository::LogID{obmcID{firstOBMCID + i}}));
+        i = (i + 1) % count;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+/** @brief Looks up a PEL ID which isn't in the repository. */
+void BM_FindMissing(benchmark::State& state)
+{
+    auto& repo = getRepository(state.range(0));
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(
+            repo.hasPEL(Repository::LogID{pelID{firstPELID - 1}}));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+/** @brief Reads the data of each PEL in turn. */
+void BM_GetPELData(benchmark::State& state)
+{
+    auto& repo = getRepository(maxSizedPELs, maxPELSize);
+
+    uint32_t i = 0;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(
+            repo.getPELData(Repository::LogID{pelID{firstPELID + i}}));
+        i = (i + 1) % maxSizedPELs;
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(state.iterations() * maxPELSize);
+}
+
+/** @brief Reads and parses every PEL. */
+void BM_ForEach(benchmark::State& state)
+{
+    auto& repo = getRepository(maxSizedPELs, maxPELSize);
+
+    for (auto _ : state)
+    {
+        repo.for_each([](const PEL& pel) {
+            benchmark::DoNotOptimize(pel.id());
+            return false;
+        });
+    }
+    state.SetItemsProcessed(state.iterations() * maxSizedPELs);
+    state.SetBytesProcessed(state.iterations() * maxSizedPELs * maxPELSize);
+}
+
+/** @brief Reads and parses each PEL in turn for an update which changes
+ *         nothing, so nothing is written back. */
+void BM_UpdatePELUnchanged(benchmark::State& state)
+{
+    auto& repo = getRepository(maxSizedPELs, maxPELSize);
+
+    std::vector<fs::path> paths;
+    for (uint32_t i = 0; i < maxSizedPELs; ++i)
+    {
+        paths.push_back(
+            repo.getPELAttributes(Repository::LogID{pelID{firstPELID + i}})
+                ->get()
+                .path);
+    }
+
+    uint32_t i = 0;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(
+            repo.updatePEL(paths[i], [](PEL&) { return false; }));
+        i = (i + 1) % maxSizedPELs;
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(state.iterations() * maxPELSize);
+}
+
+} // namespace
+
+BENCHMARK(BM_FindByPELID)->Arg(3000)->Arg(30000);
+BENCHMARK(BM_FindByOBMCID)->Arg(3000)->Arg(30000);
+BENCHMARK(BM_FindMissing)->Arg(3000)->Arg(30000);
+BENCHMARK(BM_GetPELData);
+BENCHMARK(BM_ForEach);
+BENCHMARK(BM_UpdatePELUnchanged);
+
+BENCHMARK_MAIN();
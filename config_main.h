@@ -1,5 +1,6 @@
 #pragma once
 
 const char* ERRLOG_PERSIST_PATH = "/var/lib/phosphor-logging/errors";
+const char* ERRLOG_STORE_PATH = "/var/lib/phosphor-logging/store";
 const char* EXTENSION_PERSIST_DIR = "/var/lib/phosphor-logging/extensions";
 const bool IS_UNIT_TEST = false;
@@ -1,9 +1,7 @@
 #include "elog_entry.hpp"
 
-#include "elog_serialize.hpp"
 #include "log_manager.hpp"
 
-#include <fcntl.h>
 #include <unistd.h>
 
 #include <xyz/openbmc_project/Common/File/error.hpp>
@@ -36,7 +34,7 @@ bool Entry::resolved(bool value)
                           .count();
         updateTimestamp(ms);
 
-        serialize(*this);
+        parent.markDirty(id());
     }
 
     return current;
@@ -51,7 +49,7 @@ std::string Entry::eventId(std::string value)
         current =
             sdbusplus::server::xyz::openbmc_project::logging::Entry::eventId(
                 value);
-        serialize(*this);
+        parent.markDirty(id());
     }
 
     return current;
@@ -66,7 +64,7 @@ std::string Entry::resolution(std::string value)
         current =
             sdbusplus::server::xyz::openbmc_project::logging::Entry::resolution(
                 value);
-        serialize(*this);
+        parent.markDirty(id());
     }
 
     return current;
@@ -74,7 +72,10 @@ std::string Entry::resolution(std::string value)
 
 sdbusplus::message::unix_fd Entry::getEntry()
 {
-    int fd = open(path().c_str(), O_RDONLY | O_NONBLOCK);
+    // Make sure the latest property values are in what gets handed out.
+    parent.flushEntry(id());
+
+    int fd = parent.getEntryStore().open(*this);
     if (fd == -1)
     {
         auto e = errno;
@@ -31,6 +31,28 @@ namespace internal
 class Manager;
 }
 
+/** @struct EntryData
+ *  @brief The persisted properties of an error entry, decoded without
+ *         putting a d-bus object on the bus.
+ */
+struct EntryData
+{
+    using Level =
+        sdbusplus::server::xyz::openbmc_project::logging::Entry::Level;
+
+    uint32_t id{};
+    Level severity{};
+    uint64_t timestamp{};
+    std::string message{};
+    std::vector<std::string> additionalData{};
+    AssociationList associations{};
+    bool resolved{};
+    std::string fwVersion{};
+    uint64_t updateTimestamp{};
+    std::string eventId{};
+    std::string resolution{};
+};
+
 /** @class Entry
  *  @brief OpenBMC logging entry implementation.
  *  @details A concrete implementation for the
@@ -106,6 +128,36 @@ class Entry : public EntryIfaces
         id(entryId, true);
     };
 
+    /** @brief Constructor that puts a restored error object on the bus.
+     *         Caller should emit the added signal.
+     *  @param[in] bus - Bus to attach to.
+     *  @param[in] objectPath - Path to attach at.
+     *  @param[in] data - The persisted properties.
+     *  @param[in] filePath - Serialization path
+     *  @param[in] parent - The error's parent.
+     */
+    Entry(sdbusplus::bus_t& bus, const std::string& objectPath,
+          EntryData&& data, const std::string& filePath,
+          internal::Manager& parent) :
+        EntryIfaces(bus, objectPath.c_str(), EntryIfaces::action::defer_emit),
+        parent(parent)
+    {
+        id(data.id, true);
+        severity(data.severity, true);
+        timestamp(data.timestamp, true);
+        message(std::move(data.message), true);
+        additionalData(std::move(data.additionalData), true);
+        associations(std::move(data.associations), true);
+        sdbusplus::server::xyz::openbmc_project::logging::Entry::resolved(
+            data.resolved, true);
+        version(std::move(data.fwVersion), true);
+        purpose(VersionPurpose::BMC, true);
+        updateTimestamp(data.updateTimestamp, true);
+        eventId(std::move(data.eventId), true);
+        resolution(std::move(data.resolution), true);
+        path(filePath, true);
+    };
+
     /** @brief Set resolution status of the error.
      *  @param[in] value - boolean indicating resolution
      *  status (true = resolved)
@@ -2,18 +2,24 @@
 
 #include "elog_serialize.hpp"
 
+#include <fcntl.h>
+#include <unistd.h>
+
 #include <cereal/archives/binary.hpp>
 #include <cereal/types/string.hpp>
 #include <cereal/types/tuple.hpp>
 #include <cereal/types/vector.hpp>
 #include <phosphor-logging/log.hpp>
 
+#include <cerrno>
 #include <fstream>
+#include <sstream>
 
 // Register class version
 // From cereal documentation;
 // "This macro should be placed at global scope"
 CEREAL_CLASS_VERSION(phosphor::logging::Entry, CLASS_VERSION)
+CEREAL_CLASS_VERSION(phosphor::logging::EntryData, CLASS_VERSION)
 
 namespace phosphor
 {
@@ -38,86 +44,162 @@ void save(Archive& a, const Entry& e, const std::uint32_t /*version*/)
 /** @brief Function required by Cereal to perform deserialization.
  *  @tparam Archive - Cereal archive type (binary in our case).
  *  @param[in] a       - reference to Cereal archive.
- *  @param[in] e       - reference to error entry.
+ *  @param[in] data    - reference to the decoded properties.
  *  @param[in] version - Class version that enables handling
  *                       a serialized data across code levels
  */
 template <class Archive>
-void load(Archive& a, Entry& e, const std::uint32_t version)
+void load(Archive& a, EntryData& data, const std::uint32_t version)
 {
-    using namespace sdbusplus::server::xyz::openbmc_project::logging;
-
-    uint32_t id{};
-    Entry::Level severity{};
-    uint64_t timestamp{};
-    std::string message{};
-    std::vector<std::string> additionalData{};
-    bool resolved{};
-    AssociationList associations{};
-    std::string fwVersion{};
-    uint64_t updateTimestamp{};
-    std::string eventId{};
-    std::string resolution{};
-
     if (version < std::stoul(FIRST_CEREAL_CLASS_VERSION_WITH_FWLEVEL))
     {
-        a(id, severity, timestamp, message, additionalData, associations,
-          resolved);
-        updateTimestamp = timestamp;
+        a(data.id, data.severity, data.timestamp, data.message,
+          data.additionalData, data.associations, data.resolved);
+        data.updateTimestamp = data.timestamp;
     }
     else if (version < std::stoul(FIRST_CEREAL_CLASS_VERSION_WITH_UPDATE_TS))
     {
-        a(id, severity, timestamp, message, additionalData, associations,
-          resolved, fwVersion);
-        updateTimestamp = timestamp;
+        a(data.id, data.severity, data.timestamp, data.message,
+          data.additionalData, data.associations, data.resolved,
+          data.fwVersion);
+        data.updateTimestamp = data.timestamp;
     }
     else if (version < std::stoul(FIRST_CEREAL_CLASS_VERSION_WITH_EVENTID))
     {
-        a(id, severity, timestamp, message, additionalData, associations,
-          resolved, fwVersion, updateTimestamp);
+        a(data.id, data.severity, data.timestamp, data.message,
+          data.additionalData, data.associations, data.resolved,
+          data.fwVersion, data.updateTimestamp);
     }
     else if (version < std::stoul(FIRST_CEREAL_CLASS_VERSION_WITH_RESOLUTION))
     {
-        a(id, severity, timestamp, message, additionalData, associations,
-          resolved, fwVersion, updateTimestamp, eventId);
+        a(data.id, data.severity, data.timestamp, data.message,
+          data.additionalData, data.associations, data.resolved,
+          data.fwVersion, data.updateTimestamp, data.eventId);
     }
     else
     {
-        a(id, severity, timestamp, message, additionalData, associations,
-          resolved, fwVersion, updateTimestamp, eventId, resolution);
+        a(data.id, data.severity, data.timestamp, data.message,
+          data.additionalData, data.associations, data.resolved,
+          data.fwVersion, data.updateTimestamp, data.eventId,
+          data.resolution);
     }
+}
 
-    e.id(id, true);
-    e.severity(severity, true);
-    e.timestamp(timestamp, true);
-    e.message(message, true);
-    e.additionalData(additionalData, true);
+/** @brief Function required by Cereal to perform deserialization.
+ *  @tparam Archive - Cereal archive type (binary in our case).
+ *  @param[in] a       - reference to Cereal archive.
+ *  @param[in] e       - reference to error entry.
+ *  @param[in] version - Class version that enables handling
+ *                       a serialized data across code levels
+ */
+template <class Archive>
+void load(Archive& a, Entry& e, const std::uint32_t version)
+{
+    EntryData data;
+    load(a, data, version);
+
+    e.id(data.id, true);
+    e.severity(data.severity, true);
+    e.timestamp(data.timestamp, true);
+    e.message(data.message, true);
+    e.additionalData(data.additionalData, true);
     e.sdbusplus::server::xyz::openbmc_project::logging::Entry::resolved(
-        resolved, true);
-    e.associations(associations, true);
-    e.version(fwVersion, true);
+        data.resolved, true);
+    e.associations(data.associations, true);
+    e.version(data.fwVersion, true);
     e.purpose(sdbusplus::server::xyz::openbmc_project::software::Version::
                   VersionPurpose::BMC,
               true);
-    e.updateTimestamp(updateTimestamp, true);
-    e.eventId(eventId, true);
-    e.resolution(resolution, true);
+    e.updateTimestamp(data.updateTimestamp, true);
+    e.eventId(data.eventId, true);
+    e.resolution(data.resolution, true);
 }
 
+/** @brief The version of the serializeUpdatesToString() format */
+constexpr uint32_t updatesVersion = 1;
+
 fs::path getEntrySerializePath(uint32_t id, const fs::path& dir)
 {
     return dir / std::to_string(id);
 }
 
+fs::path getEntryTempPath(uint32_t id, const fs::path& dir)
+{
+    return dir / (std::to_string(id) + ".tmp");
+}
+
+/** @brief Writes a buffer to a file, replacing what was there.
+ *  @param[in] path - the file
+ *  @param[in] data - what to write
+ *  @param[in] sync - if the data should be flushed to disk before returning
+ *  @return bool - true if the whole buffer was written
+ */
+static bool writeFile(const fs::path& path, const std::string& data,
+                      bool sync)
+{
+    int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC,
+                  0644);
+    if (fd < 0)
+    {
+        log<level::ERR>("Failed to open event log file",
+                        entry("PATH=%s", path.c_str()),
+                        entry("ERRNO=%d", errno));
+        return false;
+    }
+
+    size_t written = 0;
+    while (written < data.size())
+    {
+        auto rc = write(fd, data.data() + written, data.size() - written);
+        if (rc < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            break;
+        }
+        written += rc;
+    }
+
+    bool ok = (written == data.size()) && (!sync || (fdatasync(fd) == 0));
+    if (!ok)
+    {
+        log<level::ERR>("Failed to write event log file",
+                        entry("PATH=%s", path.c_str()),
+                        entry("ERRNO=%d", errno));
+    }
+
+    close(fd);
+    return ok;
+}
+
 fs::path serialize(const Entry& e, const fs::path& dir)
 {
     auto path = getEntrySerializePath(e.id(), dir);
-    std::ofstream os(path.c_str(), std::ios::binary);
-    cereal::BinaryOutputArchive oarchive(os);
-    oarchive(e);
+    auto temp = getEntryTempPath(e.id(), dir);
+
+    if (writeFile(temp, serializeToString(e), true))
+    {
+        std::error_code ec;
+        fs::rename(temp, path, ec);
+        if (ec)
+        {
+            log<level::ERR>("Failed to rename event log file",
+                            entry("PATH=%s", path.c_str()),
+                            entry("ERROR=%s", ec.message().c_str()));
+        }
+    }
+
     return path;
 }
 
+bool serializeToTemp(const Entry& e, const fs::path& dir)
+{
+    return writeFile(getEntryTempPath(e.id(), dir), serializeToString(e),
+                     false);
+}
+
 bool deserialize(const fs::path& path, Entry& e)
 {
     try
@@ -151,5 +233,117 @@ bool deserialize(const fs::path& path, Entry& e)
     }
 }
 
+bool deserialize(const fs::path& path, EntryData& data)
+{
+    std::ifstream is(path.c_str(), std::ios::in | std::ios::binary);
+    if (!is)
+    {
+        return false;
+    }
+
+    try
+    {
+        cereal::BinaryInputArchive iarchive(is);
+        iarchive(data);
+        return true;
+    }
+    catch (const cereal::Exception& ex)
+    {
+        log<level::ERR>(ex.what());
+        return false;
+    }
+    catch (const std::length_error& ex)
+    {
+        log<level::ERR>(ex.what());
+        return false;
+    }
+}
+
+std::string serializeToString(const Entry& e)
+{
+    std::ostringstream os(std::ios::binary);
+    {
+        cereal::BinaryOutputArchive oarchive(os);
+        oarchive(e);
+    }
+    return os.str();
+}
+
+bool deserializeFromString(const std::string& buffer, EntryData& data)
+{
+    try
+    {
+        std::istringstream is(buffer, std::ios::binary);
+        cereal::BinaryInputArchive iarchive(is);
+        iarchive(data);
+        return true;
+    }
+    catch (const cereal::Exception& ex)
+    {
+        log<level::ERR>(ex.what());
+        return false;
+    }
+    catch (const std::length_error& ex)
+    {
+        log<level::ERR>(ex.what());
+        return false;
+    }
+}
+
+std::string serializeUpdatesToString(const Entry& e)
+{
+    std::ostringstream os(std::ios::binary);
+    {
+        cereal::BinaryOutputArchive oarchive(os);
+        oarchive(updatesVersion, e.severity(), e.resolved(), e.associations(),
+                 e.updateTimestamp(), e.eventId(), e.resolution());
+    }
+    return os.str();
+}
+
+bool deserializeUpdatesFromString(const std::string& buffer, EntryData& data)
+{
+    uint32_t version{};
+    EntryData::Level severity{};
+    bool resolved{};
+    AssociationList associations{};
+    uint64_t updateTimestamp{};
+    std::string eventId{};
+    std::string resolution{};
+
+    try
+    {
+        std::istringstream is(buffer, std::ios::binary);
+        cereal::BinaryInputArchive iarchive(is);
+        iarchive(version);
+        if (version != updatesVersion)
+        {
+            log<level::ERR>("Unsupported event log update record version",
+                            entry("VERSION=%u", version));
+            return false;
+        }
+        iarchive(severity, resolved, associations, updateTimestamp, eventId,
+                 resolution);
+    }
+    catch (const cereal::Exception& ex)
+    {
+        log<level::ERR>(ex.what());
+        return false;
+    }
+    catch (const std::length_error& ex)
+    {
+        log<level::ERR>(ex.what());
+        return false;
+    }
+
+    data.severity = severity;
+    data.resolved = resolved;
+    data.associations = std::move(associations);
+    data.updateTimestamp = updateTimestamp;
+    data.eventId = std::move(eventId);
+    data.resolution = std::move(resolution);
+    return true;
+}
+
 } // namespace logging
 } // namespace phosphor
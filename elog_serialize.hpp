@@ -15,7 +15,9 @@ namespace logging
 
 namespace fs = std::filesystem;
 
-/** @brief Serialize and persist error d-bus object
+/** @brief Serialize and persist error d-bus object.  The error is
+ *         written to a temporary file, synced, and renamed over the
+ *         persisted file, so a power loss can't leave a torn file.
  *  @param[in] a - const reference to error entry.
  *  @param[in] dir - pathname of directory where the serialized error will
  *                   be placed.
@@ -24,6 +26,15 @@ namespace fs = std::filesystem;
 fs::path serialize(const Entry& e,
                    const fs::path& dir = fs::path(ERRLOG_PERSIST_PATH));
 
+/** @brief Serialize an error into its temporary file, without syncing it
+ *         or renaming it over the persisted file.
+ *  @param[in] e - const reference to error entry.
+ *  @param[in] dir - pathname of directory where the serialized error will
+ *                   be placed.
+ *  @return bool - true if the whole error was written, false otherwise.
+ */
+bool serializeToTemp(const Entry& e, const fs::path& dir);
+
 /** @brief Deserialze a persisted error into a d-bus object
  *  @param[in] path - pathname of persisted error file
  *  @param[in] e - reference to error object which is the target of
@@ -32,6 +43,43 @@ fs::path serialize(const Entry& e,
  */
 bool deserialize(const fs::path& path, Entry& e);
 
+/** @brief Decode a persisted error without creating its d-bus object.
+ *         Unlike the Entry overload, a bad file is left in place, so this
+ *         can be called from any thread.
+ *  @param[in] path - pathname of persisted error file
+ *  @param[in] data - reference to the decoded properties.
+ *  @return bool - true if the deserialization was successful, false otherwise.
+ */
+bool deserialize(const fs::path& path, EntryData& data);
+
+/** @brief Serialize an error d-bus object into a buffer, in the same
+ *         format that serialize() writes to the file.
+ *  @param[in] e - const reference to error entry.
+ *  @return std::string - the serialized error
+ */
+std::string serializeToString(const Entry& e);
+
+/** @brief Decode an error from a serializeToString() buffer
+ *  @param[in] buffer - the serialized error
+ *  @param[in] data - reference to the decoded properties.
+ *  @return bool - true if the deserialization was successful, false otherwise.
+ */
+bool deserializeFromString(const std::string& buffer, EntryData& data);
+
+/** @brief Serialize only the properties of an error d-bus object that can
+ *         change after it has been created.
+ *  @param[in] e - const reference to error entry.
+ *  @return std::string - the serialized properties
+ */
+std::string serializeUpdatesToString(const Entry& e);
+
+/** @brief Apply the properties from a serializeUpdatesToString() buffer
+ *  @param[in] buffer - the serialized properties
+ *  @param[in] data - reference to the decoded properties to update.
+ *  @return bool - true if the deserialization was successful, false otherwise.
+ */
+bool deserializeUpdatesFromString(const std::string& buffer, EntryData& data);
+
 /** @brief Return the path to serialize a log entry to
  *  @param[in] id - log entry ID
  *  @param[in] dir - pathname of directory where the serialized error will
@@ -42,5 +90,15 @@ fs::path
     getEntrySerializePath(uint32_t id,
                           const fs::path& dir = fs::path(ERRLOG_PERSIST_PATH));
 
+/** @brief Return the path a log entry is written to before it is renamed
+ *         over its serialize path
+ *  @param[in] id - log entry ID
+ *  @param[in] dir - pathname of directory where the serialized error will
+ *                   be placed.
+ *  @return fs::path - pathname of the temporary file
+ */
+fs::path getEntryTempPath(uint32_t id,
+                          const fs::path& dir = fs::path(ERRLOG_PERSIST_PATH));
+
 } // namespace logging
 } // namespace phosphor
@@ -0,0 +1,205 @@
+#include "config.h"
+
+#include "entry_store.hpp"
+
+#include "elog_serialize.hpp"
+#include "log_store.hpp"
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <phosphor-logging/lg2.hpp>
+
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <string_view>
+
+namespace phosphor
+{
+namespace logging
+{
+
+std::unique_ptr<EntryStore> EntryStore::create()
+{
+    if (ENTRY_STORE_LOG)
+    {
+        return std::make_unique<LogStore>(ERRLOG_STORE_PATH,
+                                          ERRLOG_PERSIST_PATH);
+    }
+
+    return std::make_unique<FileStore>(ERRLOG_PERSIST_PATH);
+}
+
+FileStore::~FileStore()
+{
+    sync();
+}
+
+void FileStore::save(const Entry& e)
+{
+    if (serializeToTemp(e, dir))
+    {
+        staged.insert(e.id());
+        groupCommit.add();
+    }
+}
+
+bool FileStore::read(uint32_t id, EntryData& data)
+{
+    return deserialize(getEntrySerializePath(id, dir), data);
+}
+
+void FileStore::remove(uint32_t id)
+{
+    std::error_code ec;
+    if (staged.erase(id) != 0)
+    {
+        fs::remove(getEntryTempPath(id, dir), ec);
+    }
+    fs::remove(getEntrySerializePath(id, dir), ec);
+}
+
+void FileStore::removeBatch(const std::vector<uint32_t>& ids)
+{
+    if (ids.empty())
+    {
+        return;
+    }
+
+    std::set<uint32_t> doomed(ids.begin(), ids.end());
+    for (auto id : ids)
+    {
+        staged.erase(id);
+    }
+
+    DIR* d = opendir(dir.c_str());
+    if (d == nullptr)
+    {
+        lg2::error("Failed to open the event log directory {PATH}: {ERROR}",
+                   "PATH", dir.string(), "ERROR", strerror(errno));
+        return;
+    }
+
+    // Both the entry files and any uncommitted temporary files go, and
+    // unlinking relative to the directory saves a path lookup per file.
+    while (auto* file = readdir(d))
+    {
+        std::string_view name{file->d_name};
+        uint32_t id{};
+        auto [end, ec] = std::from_chars(name.data(),
+                                         name.data() + name.size(), id);
+        if ((ec != std::errc{}) || (end == name.data()) ||
+            !doomed.contains(id))
+        {
+            continue;
+        }
+
+        std::string_view rest{end,
+                              static_cast<size_t>(name.data() + name.size() -
+                                                  end)};
+        if ((rest.empty() || (rest == ".tmp")) &&
+            (unlinkat(dirfd(d), file->d_name, 0) != 0) && (errno != ENOENT))
+        {
+            lg2::error("Failed to remove event log file {NAME}: {ERROR}",
+                       "NAME", name, "ERROR", strerror(errno));
+        }
+    }
+
+    closedir(d);
+}
+
+std::vector<uint32_t> FileStore::getIDs()
+{
+    std::vector<uint32_t> ids;
+
+    if (!fs::exists(dir) || fs::is_empty(dir))
+    {
+        return ids;
+    }
+
+    for (auto& file : fs::directory_iterator(dir))
+    {
+        // A write that was never committed.  The entry file it was going
+        // to replace, if any, is still intact.
+        if (file.path().extension() == ".tmp")
+        {
+            std::error_code ec;
+            fs::remove(file.path(), ec);
+            continue;
+        }
+
+        ids.push_back(std::stol(file.path().filename().c_str()));
+    }
+
+    // Oldest first, like the log store.
+    std::sort(ids.begin(), ids.end());
+
+    return ids;
+}
+
+int FileStore::open(const Entry& e)
+{
+    // The entry file is only replaced once the new version is committed.
+    if (staged.contains(e.id()))
+    {
+        sync();
+    }
+
+    return ::open(e.path().c_str(), O_RDONLY | O_NONBLOCK);
+}
+
+void FileStore::commit()
+{
+    if (staged.empty())
+    {
+        return;
+    }
+
+    for (auto id : staged)
+    {
+        auto temp = getEntryTempPath(id, dir);
+
+        // Only replace the entry file once the new version is on flash.
+        // If it can't be synced, the old version stays, and the temporary
+        // file is cleaned up at the next startup.
+        int fd = ::open(temp.c_str(), O_RDONLY | O_CLOEXEC);
+        if ((fd < 0) || (fdatasync(fd) != 0))
+        {
+            lg2::error("Failed to sync event log {ID}: {ERROR}", "ID", id,
+                       "ERROR", strerror(errno));
+            if (fd >= 0)
+            {
+                close(fd);
+            }
+            continue;
+        }
+        close(fd);
+
+        std::error_code ec;
+        fs::rename(temp, getEntrySerializePath(id, dir), ec);
+        if (ec)
+        {
+            lg2::error("Failed to commit event log {ID}: {ERROR}", "ID", id,
+                       "ERROR", ec.message());
+        }
+    }
+    staged.clear();
+
+    // One directory sync makes all of the renames durable.
+    int dirFD = ::open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if ((dirFD < 0) || (fsync(dirFD) != 0))
+    {
+        lg2::error("Failed to sync the event log directory {PATH}: {ERROR}",
+                   "PATH", dir.string(), "ERROR", strerror(errno));
+    }
+    if (dirFD >= 0)
+    {
+        close(dirFD);
+    }
+}
+
+} // namespace logging
+} // namespace phosphor
@@ -0,0 +1,171 @@
+#pragma once
+
+#include "elog_entry.hpp"
+#include "group_commit.hpp"
+
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <set>
+#include <vector>
+
+namespace phosphor
+{
+namespace logging
+{
+
+namespace fs = std::filesystem;
+
+/** @class EntryStore
+ *  @brief Where event log entries are persisted.
+ *  @details The log manager and its entries only go through this
+ *           interface, so the on-flash format can be chosen at build time.
+ *
+ *           Saves aren't synced to flash one at a time.  They are made
+ *           durable together by a group commit shortly afterwards, or
+ *           right away by sync().
+ */
+class EntryStore
+{
+  public:
+    EntryStore() :
+        groupCommit(std::bind(std::mem_fn(&EntryStore::commit), this))
+    {}
+    EntryStore(const EntryStore&) = delete;
+    EntryStore& operator=(const EntryStore&) = delete;
+    EntryStore(EntryStore&&) = delete;
+    EntryStore& operator=(EntryStore&&) = delete;
+    virtual ~EntryStore() = default;
+
+    /** @brief Persist a new entry, or the new property values of an
+     *         existing one.
+     *
+     *  @param[in] e - The entry
+     */
+    virtual void save(const Entry& e) = 0;
+
+    /** @brief Decode a persisted entry.
+     *
+     *  Once getIDs() has been called, this may be called from several
+     *  threads at once, as long as nothing is saved or removed meanwhile.
+     *  An entry that can't be decoded is left for the caller to remove.
+     *
+     *  @param[in] id - The entry ID
+     *  @param[out] data - The persisted properties
+     *
+     *  @return bool - true if the entry was decoded
+     */
+    virtual bool read(uint32_t id, EntryData& data) = 0;
+
+    /** @brief Delete a persisted entry.
+     *
+     *  @param[in] id - The entry ID
+     */
+    virtual void remove(uint32_t id) = 0;
+
+    /** @brief Delete several persisted entries at once.
+     *
+     *  @param[in] ids - The entry IDs
+     */
+    virtual void removeBatch(const std::vector<uint32_t>& ids)
+    {
+        for (auto id : ids)
+        {
+            remove(id);
+        }
+    }
+
+    /** @brief Returns the IDs of all persisted entries.
+     *
+     *  @return std::vector<uint32_t> - The IDs
+     */
+    virtual std::vector<uint32_t> getIDs() = 0;
+
+    /** @brief Opens the serialized form of an entry for reading, for the
+     *         GetEntry D-Bus method.
+     *
+     *  @param[in] e - The entry
+     *
+     *  @return int - The file descriptor, or -1 with errno set on failure
+     */
+    virtual int open(const Entry& e) = 0;
+
+    /** @brief Make everything saved so far durable now, instead of
+     *         waiting for the group commit.
+     */
+    void sync()
+    {
+        groupCommit.commitNow();
+    }
+
+    /** @brief Returns the group commit batch size and latency counters */
+    const GroupCommit::Stats& getCommitStats() const
+    {
+        return groupCommit.getStats();
+    }
+
+    /** @brief Creates the store selected at build time.
+     *
+     *  @return The store
+     */
+    static std::unique_ptr<EntryStore> create();
+
+  protected:
+    /** @brief Make the saves since the last commit durable. */
+    virtual void commit() = 0;
+
+    /** @brief Batches the commits */
+    GroupCommit groupCommit;
+};
+
+/** @class FileStore
+ *  @brief Persists each entry to its own cereal file, named after its ID,
+ *         under a directory.
+ *  @details An entry is written to a temporary file first.  The commit
+ *           fdatasync()s each temporary file written in the window, renames
+ *           it over the entry file, and then syncs the directory once, so a
+ *           power loss leaves either the old or the new version of an
+ *           entry, never a torn one.
+ */
+class FileStore : public EntryStore
+{
+  public:
+    /** @brief Constructor
+     *
+     *  @param[in] dir - The directory of the entry files
+     */
+    explicit FileStore(const fs::path& dir) : dir(dir) {}
+
+    /** @brief Destructor, which commits any pending saves */
+    ~FileStore() override;
+
+    void save(const Entry& e) override;
+
+    bool read(uint32_t id, EntryData& data) override;
+
+    void remove(uint32_t id) override;
+
+    /** @brief Delete several entry files in a single pass over the
+     *         directory.
+     *
+     *  @param[in] ids - The entry IDs
+     */
+    void removeBatch(const std::vector<uint32_t>& ids) override;
+
+    std::vector<uint32_t> getIDs() override;
+
+    int open(const Entry& e) override;
+
+  protected:
+    void commit() override;
+
+  private:
+    /** @brief The directory of the entry files */
+    const fs::path dir;
+
+    /** @brief IDs of the entries whose temporary files aren't committed */
+    std::set<uint32_t> staged;
+};
+
+} // namespace logging
+} // namespace phosphor
@@ -23,6 +23,12 @@ DeleteFunctions& Extensions::getDeleteFunctions()
     return deleteFunctions;
 }
 
+DeleteBatchFunctions& Extensions::getDeleteBatchFunctions()
+{
+    static DeleteBatchFunctions deleteBatchFunctions{};
+    return deleteBatchFunctions;
+}
+
 DeleteProhibitedFunctions& Extensions::getDeleteProhibitedFunctions()
 {
     static DeleteProhibitedFunctions deleteProhibitedFunctions{};
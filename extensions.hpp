@@ -42,6 +42,13 @@ using CreateFunction = std::function<void(
  */
 using DeleteFunction = std::function<void(uint32_t)>;
 
+/**
+ * @brief The function type that will be called after event logs are deleted,
+ *        with all of the logs deleted at once, such as by a DeleteAll.
+ * @param[in] const std::vector<uint32_t>& - The event log IDs
+ */
+using DeleteBatchFunction = std::function<void(const std::vector<uint32_t>&)>;
+
 /**
  * @brief The function type that will to check if an event log is prohibited
  *        from being deleted.
@@ -53,6 +60,7 @@ using DeleteProhibitedFunction = std::function<void(uint32_t, bool&)>;
 using StartupFunctions = std::vector<StartupFunction>;
 using CreateFunctions = std::vector<CreateFunction>;
 using DeleteFunctions = std::vector<DeleteFunction>;
+using DeleteBatchFunctions = std::vector<DeleteBatchFunction>;
 using DeleteProhibitedFunctions = std::vector<DeleteProhibitedFunction>;
 
 /**
@@ -144,6 +152,20 @@ class Extensions
         getDeleteFunctions().push_back(func);
     }
 
+    /**
+     * @brief Constructor to register a delete batch function
+     *
+     * Functions registered with this contructor will be called
+     * after phosphor-log-manager deletes one or more event logs,
+     * once for all of the logs deleted together.
+     *
+     * @param[in] func - The delete batch function to register
+     */
+    explicit Extensions(DeleteBatchFunction func)
+    {
+        getDeleteBatchFunctions().push_back(func);
+    }
+
     /**
      * @brief Constructor to register a delete prohibition function
      *
@@ -190,6 +212,12 @@ class Extensions
      */
     static DeleteFunctions& getDeleteFunctions();
 
+    /**
+     * @brief Returns the DeleteBatch functions
+     * @return DeleteBatchFunctions - the DeleteBatch functions
+     */
+    static DeleteBatchFunctions& getDeleteBatchFunctions();
+
     /**
      * @brief Returns the DeleteProhibited functions
      * @return DeleteProhibitedFunctions - the DeleteProhibited functions
@@ -45,7 +45,8 @@ void pelStartup(internal::Manager& logManager)
     std::unique_ptr<DataInterfaceBase> dataIface =
         std::make_unique<DataInterface>(logManager.getBus());
 
-    std::unique_ptr<JournalBase> journal = std::make_unique<Journal>();
+    std::unique_ptr<JournalBase> journal = std::make_unique<Journal>(
+        logManager.getJournalSync());
 
 #ifndef DONT_SEND_PELS_TO_HOST
     std::unique_ptr<HostInterface> hostIface = std::make_unique<PLDMInterface>(
@@ -87,9 +88,9 @@ void pelCreate(const std::string& message, uint32_t id, uint64_t timestamp,
 
 REGISTER_EXTENSION_FUNCTION(pelCreate)
 
-void pelDelete(uint32_t id)
+void pelDelete(const std::vector<uint32_t>& ids)
 {
-    return manager->erase(id);
+    manager->eraseBatch(ids);
 }
 
 REGISTER_EXTENSION_FUNCTION(pelDelete)
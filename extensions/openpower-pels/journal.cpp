@@ -15,8 +15,6 @@
  */
 #include "journal.hpp"
 
-#include "util.hpp"
-
 #include <phosphor-logging/log.hpp>
 
 #include <format>
@@ -55,7 +53,7 @@ void Journal::sync() const
 {
     auto start = std::chrono::steady_clock::now();
 
-    util::journalSync();
+    _journalSync.sync();
 
     auto end = std::chrono::steady_clock::now();
     auto duration =
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "journal_sync.hpp"
+
 #include <systemd/sd-journal.h>
 
 #include <string>
@@ -47,12 +49,21 @@ class JournalBase
 class Journal : public JournalBase
 {
   public:
-    Journal() = default;
+    Journal() = delete;
     ~Journal() = default;
     Journal(const Journal&) = default;
-    Journal& operator=(const Journal&) = default;
+    Journal& operator=(const Journal&) = delete;
     Journal(Journal&&) = default;
-    Journal& operator=(Journal&&) = default;
+    Journal& operator=(Journal&&) = delete;
+
+    /**
+     * @brief Constructor
+     *
+     * @param journalSync - The log manager's journal sync service
+     */
+    explicit Journal(phosphor::logging::JournalSync& journalSync) :
+        _journalSync(journalSync)
+    {}
 
     /**
      * @brief Get messages from the journal
@@ -90,5 +101,11 @@ class Journal : public JournalBase
      * @return std::string - A timestamp string
      */
     std::string getTimeStamp(sd_journal* journal) const;
+
+    /**
+     * @brief The journal sync service shared with the log manager, so
+     *        PEL journal captures and commits share journal flushes.
+     */
+    phosphor::logging::JournalSync& _journalSync;
 };
 } // namespace openpower::pels
@@ -16,7 +16,6 @@
 #include "manager.hpp"
 
 #include "additional_data.hpp"
-#include "elog_serialize.hpp"
 #include "json_utils.hpp"
 #include "pel.hpp"
 #include "pel_entry.hpp"
@@ -294,11 +293,22 @@ std::vector<uint8_t> Manager::eselToRawData(const std::string& esel)
 
 void Manager::erase(uint32_t obmcLogID)
 {
-    Repository::LogID id{Repository::LogID::Obmc(obmcLogID)};
+    eraseBatch({obmcLogID});
+}
+
+void Manager::eraseBatch(const std::vector<uint32_t>& obmcLogIDs)
+{
+    std::vector<Repository::LogID> ids;
+    ids.reserve(obmcLogIDs.size());
 
-    auto path = std::string(OBJ_ENTRY) + '/' + std::to_string(obmcLogID);
-    _pelEntries.erase(path);
-    _repo.remove(id);
+    for (auto obmcLogID : obmcLogIDs)
+    {
+        auto path = std::string(OBJ_ENTRY) + '/' + std::to_string(obmcLogID);
+        _pelEntries.erase(path);
+        ids.emplace_back(Repository::LogID::Obmc(obmcLogID));
+    }
+
+    _repo.removeBatch(ids);
 }
 
 bool Manager::isDeleteProhibited(uint32_t /*obmcLogID*/)
@@ -837,11 +847,9 @@ bool Manager::updateResolution(const openpower::pels::PEL& pel)
 
 void Manager::serializeLogEntry(uint32_t obmcLogID)
 {
-    auto entryN = _logManager.entries.find(obmcLogID);
-    if (entryN != _logManager.entries.end())
-    {
-        serialize(*entryN->second);
-    }
+    // Written from the event loop along with any other changes to the
+    // entry made while the PEL is being created.
+    _logManager.markDirty(obmcLogID);
 }
 
 void Manager::updateDBusSeverity(const openpower::pels::PEL& pel)
@@ -126,6 +126,16 @@ class Manager : public PELInterface
      */
     void erase(uint32_t obmcLogID);
 
+    /**
+     * @brief Erase the PELs of several OpenBMC event logs at once
+     *
+     * The PELs are removed from the repository together, so its
+     * attributes index is only written to once.
+     *
+     * @param[in] obmcLogIDs - the OpenBMC event log ids
+     */
+    void eraseBatch(const std::vector<uint32_t>& obmcLogIDs);
+
     /** @brief Says if an OpenBMC event log may not be manually deleted at this
      *         time because its corresponding PEL cannot be.
      *
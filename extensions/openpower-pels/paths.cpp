@@ -61,5 +61,10 @@ size_t getMaxNumPELs()
     return defaultMaxNumPELs;
 }
 
+size_t getPELRestoreThreads()
+{
+    return PEL_RESTORE_THREADS;
+}
+
 } // namespace pels
 } // namespace openpower
@@ -41,5 +41,16 @@ size_t getPELRepoSize();
  */
 size_t getMaxNumPELs();
 
+/**
+ * @brief Returns the number of threads, including the calling one, to
+ *        read PEL files with when restoring the repository.
+ *
+ * This is still in paths.c/hpp even though it doesn't return a path
+ * because this file is easy to override when testing.
+ *
+ * @return size_t The number of threads, at least 1.
+ */
+size_t getPELRestoreThreads();
+
 } // namespace pels
 } // namespace openpower
@@ -17,11 +17,14 @@
 
 #include <fcntl.h>
 #include <sys/stat.h>
+#include <unistd.h>
 
 #include <phosphor-logging/lg2.hpp>
 #include <xyz/openbmc_project/Common/File/error.hpp>
 
+#include <atomic>
 #include <fstream>
+#include <thread>
 
 namespace openpower
 {
@@ -33,6 +36,81 @@ namespace file_error = sdbusplus::xyz::openbmc_project::Common::File::Error;
 
 constexpr size_t warningPercentage = 95;
 
+/**
+ * The attributes index file starts with a header of the magic number and
+ * the version.  Then come records which each add, replace or remove the
+ * attributes of the PEL in one file.  Each set record has the mtime and
+ * size of the file it was made from, and when they no longer match the
+ * file is read instead.  They're appended as
+ * PELs change, and the file is rewritten with one record per PEL once too
+ * many of them are outdated.  Like PELs, everything is big endian.
+ */
+constexpr uint32_t indexMagic = 0x50454C58; // "PELX"
+constexpr uint8_t indexVersion = 1;
+
+enum class IndexRecordType : uint8_t
+{
+    set = 1,
+    remove = 2
+};
+
+/**
+ * @brief The offsets of the transmission states in the User Header.
+ *
+ * The states are its last field, a big endian word with the host's state
+ * in the low byte and the HMC's in the byte above it.
+ */
+constexpr size_t hostTransStateOffset = UserHeader::flattenedSize() - 1;
+constexpr size_t hmcTransStateOffset = UserHeader::flattenedSize() - 2;
+
+/**
+ * @brief How many more records than PELs the index can have before it
+ *        is rewritten.
+ */
+constexpr size_t maxStaleIndexRecords = 1000;
+
+/**
+ * @brief Flattens the start of an index record, common to all types.
+ *
+ * @param[in] stream - The stream to write to
+ * @param[in] type - The type of record
+ * @param[in] name - The PEL's file name, at most 255 characters
+ */
+void flattenIndexRecordHeader(Stream& stream, IndexRecordType type,
+                              const std::string& name)
+{
+    stream << static_cast<uint8_t>(type) << static_cast<uint8_t>(name.size())
+           << std::vector<char>{name.begin(), name.end()};
+}
+
+/**
+ * @brief Flattens an index record which sets the attributes of a PEL.
+ *
+ * @param[in] stream - The stream to write to
+ * @param[in] name - The PEL's file name, at most 255 characters
+ * @param[in] id - The PEL's IDs
+ * @param[in] mtime - The file's modification time, in nanoseconds
+ * @param[in] size - The file's size
+ * @param[in] attributes - The PEL's attributes
+ */
+void flattenIndexRecord(Stream& stream, const std::string& name,
+                        const Repository::LogID& id, uint64_t mtime,
+                        uint64_t size,
+                        const Repository::PELAttributes& attributes)
+{
+    uint8_t flags = (attributes.deconfig ? 0x01 : 0x00) |
+                    (attributes.guard ? 0x02 : 0x00);
+
+    flattenIndexRecordHeader(stream, IndexRecordType::set, name);
+    stream << id.pelID.id << id.obmcID.id << mtime << size
+           << static_cast<uint64_t>(attributes.sizeOnDisk) << attributes.creator
+           << attributes.subsystem << attributes.severity
+           << static_cast<uint16_t>(attributes.actionFlags.to_ulong())
+           << static_cast<uint8_t>(attributes.hostState)
+           << static_cast<uint8_t>(attributes.hmcState) << attributes.plid
+           << flags << attributes.creationTime;
+}
+
 /**
  * @brief Returns the amount of space the file uses on disk.
  *
@@ -58,11 +136,143 @@ size_t getFileDiskSize(const std::filesystem::path& file)
     return statData.st_blocks * statBlockSize;
 }
 
+/**
+ * @brief Reads a whole file.
+ *
+ * The buffer is sized from fstat() and filled with pread(), which avoids
+ * going through a streambuf a byte at a time and growing the vector as
+ * it goes.
+ *
+ * @param[in] file - The file to read
+ *
+ * @return The data, or an empty optional with errno set if the file
+ *         couldn't be opened or read.
+ */
+std::optional<std::vector<uint8_t>> readFile(const std::filesystem::path& file)
+{
+    int fd = open(file.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd == -1)
+    {
+        return std::nullopt;
+    }
+
+    struct stat statData;
+    if (fstat(fd, &statData) != 0)
+    {
+        auto e = errno;
+        close(fd);
+        errno = e;
+        return std::nullopt;
+    }
+
+    std::vector<uint8_t> data(statData.st_size);
+    size_t offset = 0;
+    while (offset < data.size())
+    {
+        auto rc = pread(fd, data.data() + offset, data.size() - offset,
+                        offset);
+        if (rc < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+
+            auto e = errno;
+            close(fd);
+            errno = e;
+            return std::nullopt;
+        }
+
+        if (rc == 0)
+        {
+            // It shrank since the fstat()
+            data.resize(offset);
+            break;
+        }
+
+        offset += rc;
+    }
+
+    close(fd);
+    return data;
+}
+
+/**
+ * @brief What restore() found in a PEL file it read.
+ */
+struct RestoredPEL
+{
+    /**
+     * @brief The PEL's IDs and attributes, or empty if it isn't valid.
+     */
+    std::optional<std::pair<Repository::LogID, Repository::PELAttributes>> pel;
+
+    /**
+     * @brief If the host state in the file has to be reset from 'sent'.
+     */
+    bool resetHostState = false;
+
+    /**
+     * @brief The exception hit while reading it, if any.
+     */
+    std::optional<std::string> error;
+};
+
+/**
+ * @brief Reads and parses a PEL file for restore().
+ *
+ * This runs on restore()'s worker threads, so it doesn't change the file
+ * or the repository.  That is left to restore() itself.
+ *
+ * @param[in] path - The PEL file
+ *
+ * @return What was found in it
+ */
+RestoredPEL readPELForRestore(const fs::path& path)
+{
+    RestoredPEL result;
+
+    try
+    {
+        auto data = readFile(path).value_or(std::vector<uint8_t>{});
+
+        PEL pel{data};
+        if (!pel.valid())
+        {
+            return result;
+        }
+
+        result.resetHostState = (pel.hostTransmissionState() ==
+                                 TransmissionState::sent);
+
+        using pelID = Repository::LogID::Pel;
+        using obmcID = Repository::LogID::Obmc;
+        result.pel.emplace(
+            Repository::LogID(pelID(pel.id()), obmcID(pel.obmcLogID())),
+            Repository::PELAttributes{
+                path, getFileDiskSize(path), pel.privateHeader().creatorID(),
+                pel.userHeader().subsystem(), pel.userHeader().severity(),
+                pel.userHeader().actionFlags(), pel.hostTransmissionState(),
+                pel.hmcTransmissionState(), pel.plid(), pel.getDeconfigFlag(),
+                pel.getGuardFlag(),
+                getMillisecondsSinceEpoch(
+                    pel.privateHeader().createTimestamp())});
+    }
+    catch (const std::exception& e)
+    {
+        result.error = e.what();
+    }
+
+    return result;
+}
+
 Repository::Repository(const std::filesystem::path& basePath, size_t repoSize,
                        size_t maxNumPELs) :
     _logPath(basePath / "logs"),
     _maxRepoSize(repoSize), _maxNumPELs(maxNumPELs),
-    _archivePath(basePath / "logs" / "archive")
+    _archivePath(basePath / "logs" / "archive"),
+    _indexPath(basePath / "attributes_index")
 {
     if (!fs::exists(_logPath))
     {
@@ -77,8 +287,77 @@ Repository::Repository(const std::filesystem::path& basePath, size_t repoSize,
     restore();
 }
 
+Repository::AttributesMap::const_iterator
+    Repository::findPEL(const LogID& id) const
+{
+    return const_cast<Repository*>(this)->findPEL(id);
+}
+
+Repository::AttributesMap::iterator Repository::findPEL(const LogID& id)
+{
+    if (id.pelID.id != 0)
+    {
+        auto entry = _pelIDIndex.find(id.pelID.id);
+        return (entry != _pelIDIndex.end()) ? entry->second
+                                             : _pelAttributes.end();
+    }
+
+    if (id.obmcID.id != 0)
+    {
+        // As if searching _pelAttributes in order, return the lowest
+        // PEL ID with this OpenBMC log ID.
+        auto [begin, end] = _obmcIDIndex.equal_range(id.obmcID.id);
+        auto entry = std::min_element(
+            begin, end, [](const auto& a, const auto& b) {
+                return a.second->first < b.second->first;
+            });
+        return (entry != end) ? entry->second : _pelAttributes.end();
+    }
+
+    return _pelAttributes.end();
+}
+
+void Repository::insertAttributes(const LogID& id,
+                                  const PELAttributes& attributes)
+{
+    auto [entry, inserted] = _pelAttributes.emplace(id, attributes);
+    if (!inserted)
+    {
+        return;
+    }
+
+    _pelIDIndex.emplace(id.pelID.id, entry);
+    if (id.obmcID.id != 0)
+    {
+        _obmcIDIndex.emplace(id.obmcID.id, entry);
+    }
+}
+
+void Repository::eraseAttributes(AttributesMap::const_iterator entry)
+{
+    _pelIDIndex.erase(entry->first.pelID.id);
+    _fileStamps.erase(entry->first.pelID.id);
+
+    auto [begin, end] = _obmcIDIndex.equal_range(entry->first.obmcID.id);
+    auto index = std::find_if(begin, end, [&entry](const auto& e) {
+        return e.second == entry;
+    });
+    if (index != end)
+    {
+        _obmcIDIndex.erase(index);
+    }
+
+    _pelAttributes.erase(entry);
+}
+
 void Repository::restore()
 {
+    bool indexComplete = true;
+    auto index = readIndex(indexComplete);
+    auto rewriteIndex = !indexComplete;
+
+    // The PEL files, along with their index records if they're up to date.
+    std::vector<std::pair<fs::path, const IndexRecord*>> files;
     for (auto& dirEntry : fs::directory_iterator(_logPath))
     {
         try
@@ -87,67 +366,141 @@ void Repository::restore()
             {
                 continue;
             }
+        }
+        catch (const std::exception& e)
+        {
+            lg2::error("Hit exception while restoring PEL file {FILE}: {ERROR}",
+                       "FILE", dirEntry.path(), "ERROR", e);
+            continue;
+        }
+
+        const IndexRecord* current = nullptr;
+        auto stamp = getFileStamp(dirEntry.path());
+        auto record = index.find(dirEntry.path().filename().string());
+        if (stamp && (record != index.end()) &&
+            (record->second.stamp == *stamp))
+        {
+            current = &record->second;
+        }
+
+        files.emplace_back(dirEntry.path(), current);
+    }
+
+    // Read the files without a record on this thread and some workers.
+    // The results are kept in directory order, so they're handled below
+    // exactly as if the files had been read one at a time.
+    std::vector<RestoredPEL> results(files.size());
+    std::atomic<size_t> next{0};
+    auto readFiles = [&files, &results, &next]() {
+        for (size_t i = next++; i < files.size(); i = next++)
+        {
+            if (files[i].second == nullptr)
+            {
+                results[i] = readPELForRestore(files[i].first);
+            }
+        }
+    };
+
+    size_t toRead = std::count_if(files.begin(), files.end(),
+                                  [](const auto& f) { return !f.second; });
+    {
+        std::vector<std::jthread> workers;
+        for (size_t i = 1; i < std::min(getPELRestoreThreads(), toRead); i++)
+        {
+            try
+            {
+                workers.emplace_back(readFiles);
+            }
+            catch (const std::system_error& e)
+            {
+                lg2::error("Unable to start a PEL restore thread: {ERROR}",
+                           "ERROR", e);
+                break;
+            }
+        }
 
-            std::ifstream file{dirEntry.path()};
-            std::vector<uint8_t> data{std::istreambuf_iterator<char>(file),
-                                      std::istreambuf_iterator<char>()};
-            file.close();
+        readFiles();
+    }
 
-            PEL pel{data};
-            if (pel.valid())
+    for (size_t i = 0; i < files.size(); i++)
+    {
+        const auto& [path, record] = files[i];
+
+        try
+        {
+            std::optional<std::pair<LogID, PELAttributes>> pel;
+            bool resetHostState = false;
+
+            if (record != nullptr)
             {
-                // If the host hasn't acked it, reset the host state so
-                // it will get sent up again.
-                if (pel.hostTransmissionState() == TransmissionState::sent)
+                pel.emplace(record->id, record->attributes);
+                resetHostState = (record->attributes.hostState ==
+                                  TransmissionState::sent);
+            }
+            else
+            {
+                rewriteIndex = true;
+
+                auto& result = results[i];
+                if (result.error)
                 {
-                    pel.setHostTransmissionState(TransmissionState::newPEL);
-                    try
-                    {
-                        write(pel, dirEntry.path());
-                    }
-                    catch (const std::exception& e)
-                    {
-                        lg2::error(
-                            "Failed to save PEL after updating host state, PEL ID = {ID}",
-                            "ID", lg2::hex, pel.id());
-                    }
+                    lg2::error(
+                        "Hit exception while restoring PEL file {FILE}: {ERROR}",
+                        "FILE", path, "ERROR", *result.error);
+                    continue;
                 }
 
-                PELAttributes attributes{
-                    dirEntry.path(),
-                    getFileDiskSize(dirEntry.path()),
-                    pel.privateHeader().creatorID(),
-                    pel.userHeader().subsystem(),
-                    pel.userHeader().severity(),
-                    pel.userHeader().actionFlags(),
-                    pel.hostTransmissionState(),
-                    pel.hmcTransmissionState(),
-                    pel.plid(),
-                    pel.getDeconfigFlag(),
-                    pel.getGuardFlag(),
-                    getMillisecondsSinceEpoch(
-                        pel.privateHeader().createTimestamp())};
-
-                using pelID = LogID::Pel;
-                using obmcID = LogID::Obmc;
-                _pelAttributes.emplace(
-                    LogID(pelID(pel.id()), obmcID(pel.obmcLogID())),
-                    attributes);
-
-                updateRepoStats(attributes, true);
+                if (!result.pel)
+                {
+                    lg2::error(
+                        "Found invalid PEL file {FILE} while restoring.  Removing.",
+                        "FILE", path);
+                    fs::remove(path);
+                    continue;
+                }
+
+                pel = std::move(result.pel);
+                resetHostState = result.resetHostState;
             }
-            else
+
+            auto& [id, attributes] = *pel;
+
+            // If the host hasn't acked it, reset the host state so
+            // it will get sent up again.
+            if (resetHostState)
+            {
+                attributes.hostState = TransmissionState::newPEL;
+                rewriteIndex = true;
+                try
+                {
+                    writeTransmissionState(path, hostTransStateOffset,
+                                           TransmissionState::newPEL);
+                }
+                catch (const std::exception& e)
+                {
+                    lg2::error(
+                        "Failed to save PEL after updating host state, PEL ID = {ID}",
+                        "ID", lg2::hex, id.pelID.id);
+                }
+            }
+
+            insertAttributes(id, attributes);
+
+            if ((record != nullptr) && !resetHostState)
             {
-                lg2::error(
-                    "Found invalid PEL file {FILE} while restoring.  Removing.",
-                    "FILE", dirEntry.path());
-                fs::remove(dirEntry.path());
+                _fileStamps.emplace(id.pelID.id, record->stamp);
             }
+            else if (auto stamp = getFileStamp(path); stamp)
+            {
+                _fileStamps.emplace(id.pelID.id, *stamp);
+            }
+
+            updateRepoStats(attributes, true);
         }
         catch (const std::exception& e)
         {
             lg2::error("Hit exception while restoring PEL file {FILE}: {ERROR}",
-                       "FILE", dirEntry.path(), "ERROR", e);
+                       "FILE", path, "ERROR", e);
         }
     }
 
@@ -156,6 +509,220 @@ void Repository::restore()
     {
         _archiveSize += getFileDiskSize(dirEntry);
     }
+
+    if (rewriteIndex || (index.size() != _pelAttributes.size()) ||
+        (_indexRecords > _pelAttributes.size() + maxStaleIndexRecords))
+    {
+        writeIndex();
+    }
+}
+
+std::optional<Repository::FileStamp>
+    Repository::getFileStamp(const fs::path& file)
+{
+    struct stat statData;
+    if (stat(file.c_str(), &statData) != 0)
+    {
+        return std::nullopt;
+    }
+
+    return FileStamp{
+        static_cast<uint64_t>(statData.st_mtim.tv_sec) * 1000000000 +
+            statData.st_mtim.tv_nsec,
+        static_cast<uint64_t>(statData.st_size)};
+}
+
+std::map<std::string, Repository::IndexRecord>
+    Repository::readIndex(bool& complete)
+{
+    std::map<std::string, IndexRecord> records;
+
+    auto data = readFile(_indexPath);
+    if (!data)
+    {
+        return records;
+    }
+
+    try
+    {
+        Stream stream{*data};
+        uint32_t magic = 0;
+        uint8_t version = 0;
+        stream >> magic >> version;
+        if ((magic != indexMagic) || (version != indexVersion))
+        {
+            throw std::runtime_error("Unknown index format");
+        }
+
+        while (stream.remaining() > 0)
+        {
+            uint8_t type = 0;
+            uint8_t nameSize = 0;
+            stream >> type >> nameSize;
+            std::vector<char> name(nameSize);
+            stream >> name;
+            std::string fileName{name.begin(), name.end()};
+
+            if (type == static_cast<uint8_t>(IndexRecordType::set))
+            {
+                uint32_t pelID = 0;
+                uint32_t obmcID = 0;
+                FileStamp stamp{0, 0};
+                uint64_t sizeOnDisk = 0;
+                uint8_t creator = 0;
+                uint8_t subsystem = 0;
+                uint8_t severity = 0;
+                uint16_t actionFlags = 0;
+                uint8_t hostState = 0;
+                uint8_t hmcState = 0;
+                uint32_t plid = 0;
+                uint8_t flags = 0;
+                uint64_t creationTime = 0;
+
+                stream >> pelID >> obmcID >> stamp.mtime >> stamp.size >>
+                    sizeOnDisk >> creator >> subsystem >> severity >>
+                    actionFlags >> hostState >> hmcState >> plid >> flags >>
+                    creationTime;
+
+                PELAttributes attributes{
+                    _logPath / fileName,
+                    sizeOnDisk,
+                    creator,
+                    subsystem,
+                    severity,
+                    actionFlags,
+                    static_cast<TransmissionState>(hostState),
+                    static_cast<TransmissionState>(hmcState),
+                    plid,
+                    (flags & 0x01) != 0,
+                    (flags & 0x02) != 0,
+                    creationTime};
+
+                records.insert_or_assign(
+                    fileName,
+                    IndexRecord{LogID{LogID::Pel{pelID}, LogID::Obmc{obmcID}},
+                                stamp, attributes});
+            }
+            else if (type == static_cast<uint8_t>(IndexRecordType::remove))
+            {
+                records.erase(fileName);
+            }
+            else
+            {
+                throw std::runtime_error("Invalid index record type");
+            }
+
+            _indexRecords++;
+        }
+    }
+    catch (const std::exception& e)
+    {
+        lg2::info("Could not read all of PEL index {FILE}: {ERROR}", "FILE",
+                  _indexPath, "ERROR", e);
+        complete = false;
+    }
+
+    return records;
+}
+
+void Repository::writeIndex()
+{
+    std::vector<uint8_t> data;
+    Stream stream{data};
+    stream << indexMagic << indexVersion;
+
+    size_t count = 0;
+    for (const auto& [id, attributes] : _pelAttributes)
+    {
+        auto stamp = _fileStamps.find(id.pelID.id);
+        auto name = attributes.path.filename().string();
+        if ((stamp == _fileStamps.end()) || (name.size() > UINT8_MAX))
+        {
+            continue;
+        }
+
+        flattenIndexRecord(stream, name, id, stamp->second.mtime,
+                           stamp->second.size, attributes);
+        count++;
+    }
+
+    // Write a new file and rename it over the old one, so there is
+    // always a whole index.
+    auto tempPath = _indexPath;
+    tempPath += ".tmp";
+
+    std::ofstream file{tempPath, std::ios::binary};
+    file.write(reinterpret_cast<const char*>(data.data()), data.size());
+    file.close();
+
+    std::error_code ec;
+    if (file.fail())
+    {
+        lg2::error("Unable to write PEL index {FILE}", "FILE", tempPath);
+        fs::remove(tempPath, ec);
+        return;
+    }
+
+    fs::rename(tempPath, _indexPath, ec);
+    if (ec)
+    {
+        lg2::error("Unable to rename PEL index {FILE}: {ERROR}", "FILE",
+                   tempPath, "ERROR", ec.message());
+        fs::remove(tempPath, ec);
+        return;
+    }
+
+    _indexRecords = count;
+}
+
+void Repository::saveIndexRecord(AttributesMap::const_iterator entry)
+{
+    auto pelID = entry->first.pelID.id;
+    auto stamp = getFileStamp(entry->second.path);
+    auto name = entry->second.path.filename().string();
+
+    // Without a record, the file is just read on the next restore.
+    if (!stamp || (name.size() > UINT8_MAX))
+    {
+        _fileStamps.erase(pelID);
+        return;
+    }
+
+    _fileStamps.insert_or_assign(pelID, *stamp);
+
+    if (_indexRecords >= _pelAttributes.size() + maxStaleIndexRecords)
+    {
+        writeIndex();
+        return;
+    }
+
+    std::vector<uint8_t> data;
+    Stream stream{data};
+    flattenIndexRecord(stream, name, entry->first, stamp->mtime, stamp->size,
+                       entry->second);
+    appendIndex(data, 1);
+}
+
+void Repository::appendIndex(const std::vector<uint8_t>& data, size_t count)
+{
+    int fd = open(_indexPath.c_str(), O_WRONLY | O_APPEND | O_CLOEXEC);
+    if (fd < 0)
+    {
+        writeIndex();
+        return;
+    }
+
+    auto rc = ::write(fd, data.data(), data.size());
+    close(fd);
+
+    // A partial record would hide any after it, so start over.
+    if (rc != static_cast<ssize_t>(data.size()))
+    {
+        writeIndex();
+        return;
+    }
+
+    _indexRecords += count;
 }
 
 std::string Repository::getPELFilename(uint32_t pelID, const BCDTime& time)
@@ -192,8 +759,9 @@ void Repository::add(std::unique_ptr<PEL>& pel)
 
     using pelID = LogID::Pel;
     using obmcID = LogID::Obmc;
-    _pelAttributes.emplace(LogID(pelID(pel->id()), obmcID(pel->obmcLogID())),
-                           attributes);
+    insertAttributes(LogID(pelID(pel->id()), obmcID(pel->obmcLogID())),
+                     attributes);
+    saveIndexRecord(findPEL(LogID(pelID(pel->id()))));
 
     _lastPelID = pel->id();
 
@@ -236,40 +804,80 @@ void Repository::write(const PEL& pel, const fs::path& path)
 
 std::optional<Repository::LogID> Repository::remove(const LogID& id)
 {
-    auto pel = findPEL(id);
-    if (pel == _pelAttributes.end())
+    auto removed = removeBatch({id});
+    if (removed.empty())
     {
         return std::nullopt;
     }
 
-    LogID actualID = pel->first;
-    updateRepoStats(pel->second, false);
+    return removed.front();
+}
+
+std::vector<Repository::LogID>
+    Repository::removeBatch(const std::vector<LogID>& ids)
+{
+    std::vector<LogID> removed;
+    removed.reserve(ids.size());
 
-    lg2::debug(
-        "Removing PEL from repository, PEL ID = {PEL_ID}, BMC log ID = {BMC_ID}",
-        "PEL_ID", lg2::hex, actualID.pelID.id, "BMC_ID", actualID.obmcID.id);
+    // The index records of the whole set are appended in one write.
+    std::vector<uint8_t> indexData;
+    Stream stream{indexData};
+    size_t indexRecords = 0;
 
-    if (fs::exists(pel->second.path))
+    for (const auto& id : ids)
     {
-        // Check for existense of new archive folder
-        if (!fs::exists(_archivePath))
+        auto pel = findPEL(id);
+        if (pel == _pelAttributes.end())
         {
-            fs::create_directories(_archivePath);
+            continue;
         }
 
-        // Move log file to archive folder
-        auto fileName = _archivePath / pel->second.path.filename();
-        fs::rename(pel->second.path, fileName);
+        LogID actualID = pel->first;
+        updateRepoStats(pel->second, false);
+
+        lg2::debug(
+            "Removing PEL from repository, PEL ID = {PEL_ID}, BMC log ID = {BMC_ID}",
+            "PEL_ID", lg2::hex, actualID.pelID.id, "BMC_ID",
+            actualID.obmcID.id);
 
-        // Update size of file
-        _archiveSize += getFileDiskSize(fileName);
+        if (fs::exists(pel->second.path))
+        {
+            // Check for existense of new archive folder
+            if (!fs::exists(_archivePath))
+            {
+                fs::create_directories(_archivePath);
+            }
+
+            // Move log file to archive folder
+            auto fileName = _archivePath / pel->second.path.filename();
+            fs::rename(pel->second.path, fileName);
+
+            // Update size of file
+            _archiveSize += getFileDiskSize(fileName);
+        }
+
+        auto name = pel->second.path.filename().string();
+        if (name.size() <= UINT8_MAX)
+        {
+            flattenIndexRecordHeader(stream, IndexRecordType::remove, name);
+            indexRecords++;
+        }
+
+        eraseAttributes(pel);
+        removed.push_back(actualID);
     }
 
-    _pelAttributes.erase(pel);
+    if (indexRecords != 0)
+    {
+        appendIndex(indexData, indexRecords);
+    }
 
-    processDeleteCallbacks(actualID.pelID.id);
+    for (const auto& id : removed)
+    {
+        processDeleteCallbacks(id.pelID.id);
+    }
 
-    return actualID;
+    return removed;
 }
 
 std::optional<std::vector<uint8_t>> Repository::getPELData(const LogID& id)
@@ -277,8 +885,8 @@ std::optional<std::vector<uint8_t>> Repository::getPELData(const LogID& id)
     auto pel = findPEL(id);
     if (pel != _pelAttributes.end())
     {
-        std::ifstream file{pel->second.path.c_str()};
-        if (!file.good())
+        auto data = readFile(pel->second.path);
+        if (!data)
         {
             auto e = errno;
             lg2::error("Unable to open PEL file {FILE}, errno = {ERRNO}",
@@ -286,8 +894,6 @@ std::optional<std::vector<uint8_t>> Repository::getPELData(const LogID& id)
             throw file_error::Open();
         }
 
-        std::vector<uint8_t> data{std::istreambuf_iterator<char>(file),
-                                  std::istreambuf_iterator<char>()};
         return data;
     }
 
@@ -319,9 +925,8 @@ void Repository::for_each(ForEachFunc func) const
 {
     for (const auto& [id, attributes] : _pelAttributes)
     {
-        std::ifstream file{attributes.path};
-
-        if (!file.good())
+        auto data = readFile(attributes.path);
+        if (!data)
         {
             auto e = errno;
             lg2::error(
@@ -330,11 +935,7 @@ void Repository::for_each(ForEachFunc func) const
             continue;
         }
 
-        std::vector<uint8_t> data{std::istreambuf_iterator<char>(file),
-                                  std::istreambuf_iterator<char>()};
-        file.close();
-
-        PEL pel{data};
+        PEL pel{*data};
 
         try
         {
@@ -399,20 +1000,16 @@ std::optional<std::reference_wrapper<const Repository::PELAttributes>>
 
 void Repository::setPELHostTransState(uint32_t pelID, TransmissionState state)
 {
-    LogID id{LogID::Pel{pelID}};
-    auto attr = std::find_if(_pelAttributes.begin(), _pelAttributes.end(),
-                             [&id](const auto& a) { return a.first == id; });
+    auto attr = findPEL(LogID{LogID::Pel{pelID}});
 
     if ((attr != _pelAttributes.end()) && (attr->second.hostState != state))
     {
-        PELUpdateFunc func = [state](PEL& pel) {
-            pel.setHostTransmissionState(state);
-            return true;
-        };
-
         try
         {
-            updatePEL(attr->second.path, func);
+            writeTransmissionState(attr->second.path, hostTransStateOffset,
+                                   state);
+            attr->second.hostState = state;
+            saveIndexRecord(attr);
         }
         catch (const std::exception& e)
         {
@@ -425,20 +1022,16 @@ void Repository::setPELHostTransState(uint32_t pelID, TransmissionState state)
 
 void Repository::setPELHMCTransState(uint32_t pelID, TransmissionState state)
 {
-    LogID id{LogID::Pel{pelID}};
-    auto attr = std::find_if(_pelAttributes.begin(), _pelAttributes.end(),
-                             [&id](const auto& a) { return a.first == id; });
+    auto attr = findPEL(LogID{LogID::Pel{pelID}});
 
     if ((attr != _pelAttributes.end()) && (attr->second.hmcState != state))
     {
-        PELUpdateFunc func = [state](PEL& pel) {
-            pel.setHMCTransmissionState(state);
-            return true;
-        };
-
         try
         {
-            updatePEL(attr->second.path, func);
+            writeTransmissionState(attr->second.path, hmcTransStateOffset,
+                                   state);
+            attr->second.hmcState = state;
+            saveIndexRecord(attr);
         }
         catch (const std::exception& e)
         {
@@ -449,12 +1042,65 @@ void Repository::setPELHMCTransState(uint32_t pelID, TransmissionState state)
     }
 }
 
+void Repository::writeTransmissionState(const fs::path& path, size_t offset,
+                                        TransmissionState state)
+{
+    int fd = open(path.c_str(), O_RDWR | O_CLOEXEC);
+    if (fd == -1)
+    {
+        auto e = errno;
+        throw std::runtime_error("Unable to open PEL file, errno = " +
+                                 std::to_string(e));
+    }
+
+    auto fail = [fd](const std::string& error) {
+        close(fd);
+        throw std::runtime_error(error);
+    };
+
+    // The User Header follows the Private Header.  Check that they're
+    // both where they should be before writing into the file.
+    auto readHeader = [fd, &fail](size_t headerOffset) {
+        std::vector<uint8_t> data(SectionHeader::flattenedSize());
+        if (pread(fd, data.data(), data.size(), headerOffset) !=
+            static_cast<ssize_t>(data.size()))
+        {
+            fail("Unable to read PEL section header");
+        }
+
+        SectionHeader header;
+        Stream stream{data};
+        stream >> header;
+        return header;
+    };
+
+    auto ph = readHeader(0);
+    if (ph.id != static_cast<uint16_t>(SectionID::privateHeader))
+    {
+        fail("Invalid private header section ID");
+    }
+
+    auto uh = readHeader(ph.size);
+    if ((uh.id != static_cast<uint16_t>(SectionID::userHeader)) ||
+        (uh.size < UserHeader::flattenedSize()))
+    {
+        fail("Invalid user header");
+    }
+
+    auto value = static_cast<uint8_t>(state);
+    if (pwrite(fd, &value, sizeof(value), ph.size + offset) !=
+        static_cast<ssize_t>(sizeof(value)))
+    {
+        auto e = errno;
+        fail("Unable to write PEL file, errno = " + std::to_string(e));
+    }
+
+    close(fd);
+}
+
 bool Repository::updatePEL(const fs::path& path, PELUpdateFunc updateFunc)
 {
-    std::ifstream file{path};
-    std::vector<uint8_t> data{std::istreambuf_iterator<char>(file),
-                              std::istreambuf_iterator<char>()};
-    file.close();
+    auto data = readFile(path).value_or(std::vector<uint8_t>{});
 
     PEL pel{data};
 
@@ -469,10 +1115,7 @@ bool Repository::updatePEL(const fs::path& path, PELUpdateFunc updateFunc)
             //  - deconfig flag - Can be cleared for PELs that call out
             //                    hotplugged FRUs.
             // Make sure they're up to date.
-            LogID id{LogID::Pel(pel.id())};
-            auto attr =
-                std::find_if(_pelAttributes.begin(), _pelAttributes.end(),
-                             [&id](const auto& a) { return a.first == id; });
+            auto attr = findPEL(LogID{LogID::Pel(pel.id())});
             if (attr != _pelAttributes.end())
             {
                 attr->second.hmcState = pel.hmcTransmissionState();
@@ -481,6 +1124,11 @@ bool Repository::updatePEL(const fs::path& path, PELUpdateFunc updateFunc)
             }
 
             write(pel, path);
+
+            if (attr != _pelAttributes.end())
+            {
+                saveIndexRecord(attr);
+            }
             return true;
         }
     }
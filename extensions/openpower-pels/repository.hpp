@@ -7,6 +7,8 @@
 #include <bitset>
 #include <filesystem>
 #include <map>
+#include <optional>
+#include <unordered_map>
 
 namespace openpower
 {
@@ -135,8 +137,8 @@ class Repository
 
     Repository() = delete;
     ~Repository() = default;
-    Repository(const Repository&) = default;
-    Repository& operator=(const Repository&) = default;
+    Repository(const Repository&) = delete;
+    Repository& operator=(const Repository&) = delete;
     Repository(Repository&&) = default;
     Repository& operator=(Repository&&) = default;
 
@@ -182,6 +184,19 @@ class Repository
      */
     std::optional<LogID> remove(const LogID& id);
 
+    /**
+     * @brief Removes several PELs from the repository
+     *
+     * The same as calling remove() on each, except that the attributes
+     * index is only appended to once for the whole set.
+     *
+     * @param[in] ids - the IDs (either the pel ID, OBMC ID, or both) to
+     *                  remove
+     *
+     * @return std::vector<LogID> - The LogIDs of the removed PELs
+     */
+    std::vector<LogID> removeBatch(const std::vector<LogID>& ids);
+
     /**
      * @brief Generates the filename to use for the PEL ID and BCDTime.
      *
@@ -471,19 +486,112 @@ class Repository
     bool updatePEL(const std::filesystem::path& path, PELUpdateFunc updateFunc);
 
   private:
+    using AttributesMap = std::map<LogID, PELAttributes>;
+
     /**
      * @brief Finds an entry in the _pelAttributes map.
      *
+     * Uses the PEL ID if it is set, and otherwise the OpenBMC log ID.
+     *
      * @param[in] id - the ID (either the pel ID, OBMC ID, or both)
      *
      * @return an iterator to the entry
      */
-    std::map<LogID, PELAttributes>::const_iterator
-        findPEL(const LogID& id) const
+    AttributesMap::const_iterator findPEL(const LogID& id) const;
+
+    /**
+     * @copydoc findPEL(const LogID&) const
+     */
+    AttributesMap::iterator findPEL(const LogID& id);
+
+    /**
+     * @brief Adds an entry to the _pelAttributes map and to the
+     *        ID indices.
+     *
+     * Does nothing if there is already an entry with the same PEL ID.
+     *
+     * @param[in] id - The PEL and OpenBMC log IDs
+     * @param[in] attributes - The attributes of the PEL
+     */
+    void insertAttributes(const LogID& id, const PELAttributes& attributes);
+
+    /**
+     * @brief Removes an entry from the _pelAttributes map and from the
+     *        ID indices.
+     *
+     * @param[in] entry - The entry to remove
+     */
+    void eraseAttributes(AttributesMap::const_iterator entry);
+
+    /**
+     * @brief The modification time and size of a PEL file, which tell if
+     *        it changed since its attributes were saved to the index.
+     */
+    struct FileStamp
     {
-        return std::find_if(_pelAttributes.begin(), _pelAttributes.end(),
-                            [&id](const auto& a) { return a.first == id; });
-    }
+        uint64_t mtime;
+        uint64_t size;
+
+        bool operator==(const FileStamp&) const = default;
+    };
+
+    /**
+     * @brief A PEL's entry in the attributes index file.
+     */
+    struct IndexRecord
+    {
+        LogID id;
+        FileStamp stamp;
+        PELAttributes attributes;
+    };
+
+    /**
+     * @brief Returns the FileStamp of a file.
+     *
+     * @param[in] file - The file
+     *
+     * @return The stamp, or an empty optional if stat() failed.
+     */
+    static std::optional<FileStamp>
+        getFileStamp(const std::filesystem::path& file);
+
+    /**
+     * @brief Reads the attributes index file.
+     *
+     * Also sets _indexRecords from it.  Any records after one that
+     * can't be read, such as one cut short by a power loss, are ignored.
+     *
+     * @param[out] complete - Set to false if part of the file couldn't
+     *                        be read, so it needs rewriting.
+     *
+     * @return The records of the PELs in the index, by file name.
+     */
+    std::map<std::string, IndexRecord> readIndex(bool& complete);
+
+    /**
+     * @brief Rewrites the attributes index file with a record for each
+     *        PEL in _pelAttributes.
+     */
+    void writeIndex();
+
+    /**
+     * @brief Appends a record to the attributes index file for a PEL
+     *        which was added or changed.
+     *
+     * Stamps the PEL's file first.  Rewrites the index instead if it
+     * has collected too many outdated records.
+     *
+     * @param[in] entry - The PEL's _pelAttributes entry
+     */
+    void saveIndexRecord(AttributesMap::const_iterator entry);
+
+    /**
+     * @brief Appends records to the attributes index file.
+     *
+     * @param[in] data - The flattened records
+     * @param[in] count - The number of records
+     */
+    void appendIndex(const std::vector<uint8_t>& data, size_t count);
 
     /**
      * @brief Call any subscribed functions for new PELs
@@ -505,6 +613,20 @@ class Repository
      */
     void restore();
 
+    /**
+     * @brief Writes a transmission state straight into the User Header
+     *        of a PEL file, rather than reading, updating and rewriting
+     *        the whole PEL.
+     *
+     * Throws exceptions on failures.
+     *
+     * @param[in] path - The PEL file
+     * @param[in] offset - The offset of the state in the User Header
+     * @param[in] state - The new state
+     */
+    void writeTransmissionState(const std::filesystem::path& path,
+                                size_t offset, TransmissionState state);
+
     /**
      * @brief Stores a PEL object in the filesystem.
      *
@@ -578,7 +700,20 @@ class Repository
     /**
      * @brief A map of the PEL/OBMC IDs to PEL attributes.
      */
-    std::map<LogID, PELAttributes> _pelAttributes;
+    AttributesMap _pelAttributes;
+
+    /**
+     * @brief The _pelAttributes entries, by PEL ID.
+     */
+    std::unordered_map<uint32_t, AttributesMap::iterator> _pelIDIndex;
+
+    /**
+     * @brief The _pelAttributes entries, by OpenBMC log ID.
+     *
+     * PELs without an OpenBMC log ID aren't in it.  A multimap, as
+     * nothing stops two PELs from having the same one.
+     */
+    std::unordered_multimap<uint32_t, AttributesMap::iterator> _obmcIDIndex;
 
     /**
      * @brief Subcriptions for new PELs.
@@ -621,6 +756,24 @@ class Repository
      * @brief The size of archive folder.
      */
     uint64_t _archiveSize = 0;
+
+    /**
+     * @brief The file that caches the attributes of the PELs, so that
+     *        restore() only has to read the PEL files which changed.
+     */
+    const std::filesystem::path _indexPath;
+
+    /**
+     * @brief The stamps the PEL files had when their attributes were
+     *        last saved to the index, by PEL ID.
+     */
+    std::unordered_map<uint32_t, FileStamp> _fileStamps;
+
+    /**
+     * @brief The number of records in the index file, including those
+     *        which later ones replaced.
+     */
+    size_t _indexRecords = 0;
 };
 
 } // namespace pels
@@ -0,0 +1,103 @@
+#include "group_commit.hpp"
+
+#include <phosphor-logging/lg2.hpp>
+#include <sdeventplus/event.hpp>
+
+#include <algorithm>
+#include <bit>
+#include <string>
+
+namespace phosphor
+{
+namespace logging
+{
+
+GroupCommit::~GroupCommit()
+{
+    report();
+}
+
+void GroupCommit::add()
+{
+    pending++;
+
+    if (!windowTimer)
+    {
+        windowTimer = std::make_unique<
+            sdeventplus::utility::Timer<sdeventplus::ClockId::Monotonic>>(
+            sdeventplus::Event::get_default(),
+            std::bind(std::mem_fn(&GroupCommit::commitNow), this));
+    }
+
+    if (!windowTimer->isEnabled())
+    {
+        windowTimer->restartOnce(window);
+    }
+}
+
+void GroupCommit::commitNow()
+{
+    if (windowTimer && windowTimer->isEnabled())
+    {
+        windowTimer->setEnabled(false);
+    }
+
+    if (pending == 0)
+    {
+        return;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    commit();
+    auto latency = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start);
+
+    stats.batches++;
+    stats.writes += pending;
+    stats.maxBatchSize = std::max<uint64_t>(stats.maxBatchSize, pending);
+    auto bucket = std::min<size_t>(std::bit_width(pending) - 1,
+                                   stats.batchSizes.size() - 1);
+    stats.batchSizes[bucket]++;
+    stats.totalLatency += latency;
+    stats.maxLatency = std::max(stats.maxLatency, latency);
+
+    lg2::debug("Committed {COUNT} event log writes in {LATENCY_US}us",
+               "COUNT", pending, "LATENCY_US", latency.count());
+
+    pending = 0;
+
+    if ((stats.batches % reportInterval) == 0)
+    {
+        report();
+    }
+}
+
+void GroupCommit::report() const
+{
+    if (stats.batches == 0)
+    {
+        return;
+    }
+
+    std::string sizes;
+    for (auto count : stats.batchSizes)
+    {
+        if (!sizes.empty())
+        {
+            sizes += '/';
+        }
+        sizes += std::to_string(count);
+    }
+
+    lg2::info(
+        "Event log group commits: {BATCHES} commits of {WRITES} writes, "
+        "largest {MAX_BATCH}, by size (1/2-3/4-7/8-15/16-31/32+) {SIZES}, "
+        "average latency {AVG_LATENCY_US}us, maximum {MAX_LATENCY_US}us",
+        "BATCHES", stats.batches, "WRITES", stats.writes, "MAX_BATCH",
+        stats.maxBatchSize, "SIZES", sizes, "AVG_LATENCY_US",
+        stats.totalLatency.count() / stats.batches, "MAX_LATENCY_US",
+        stats.maxLatency.count());
+}
+
+} // namespace logging
+} // namespace phosphor
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <sdeventplus/clock.hpp>
+#include <sdeventplus/utility/timer.hpp>
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+namespace phosphor
+{
+namespace logging
+{
+
+/** @class GroupCommit
+ *  @brief Makes writes durable in batches.
+ *  @details Writers call add() after each write instead of syncing it.  The
+ *           first write starts a short window, and when it closes a single
+ *           commit covers every write made in it, so a burst of writes
+ *           costs one flush instead of one each.  commitNow() closes the
+ *           window early for callers that can't wait.
+ *
+ *           The batch size and latency counters are logged every
+ *           reportInterval commits and when the object is destroyed.
+ */
+class GroupCommit
+{
+  public:
+    GroupCommit() = delete;
+    GroupCommit(const GroupCommit&) = delete;
+    GroupCommit& operator=(const GroupCommit&) = delete;
+    GroupCommit(GroupCommit&&) = delete;
+    GroupCommit& operator=(GroupCommit&&) = delete;
+
+    /** @brief Destructor, which logs the counters. */
+    ~GroupCommit();
+
+    using Commit = std::function<void()>;
+
+    /** @brief Counters for tuning the window */
+    struct Stats
+    {
+        /** @brief The number of commits */
+        uint64_t batches = 0;
+
+        /** @brief The number of writes committed */
+        uint64_t writes = 0;
+
+        /** @brief The largest number of writes in one commit */
+        uint64_t maxBatchSize = 0;
+
+        /** @brief The number of commits by size: 1, 2-3, 4-7, 8-15, 16-31,
+         *         and 32 or more writes. */
+        std::array<uint64_t, 6> batchSizes{};
+
+        /** @brief The total time spent committing */
+        std::chrono::microseconds totalLatency{0};
+
+        /** @brief The longest time spent on one commit */
+        std::chrono::microseconds maxLatency{0};
+    };
+
+    /** @brief Constructor
+     *
+     *  Nothing is set up on the event loop until the first write.
+     *
+     *  @param[in] commit - Makes the writes so far durable
+     *  @param[in] window - How long to collect writes before committing
+     */
+    explicit GroupCommit(Commit commit,
+                         std::chrono::milliseconds window = defaultWindow) :
+        commit(std::move(commit)), window(window)
+    {}
+
+    /** @brief Records a write that needs to be committed. */
+    void add();
+
+    /** @brief Commits the pending writes now, if there are any. */
+    void commitNow();
+
+    /** @brief Returns the number of writes not committed yet */
+    size_t getPending() const
+    {
+        return pending;
+    }
+
+    /** @brief Returns the counters */
+    const Stats& getStats() const
+    {
+        return stats;
+    }
+
+    /** @brief The default window to collect writes in. */
+    static constexpr std::chrono::milliseconds defaultWindow{20};
+
+    /** @brief How many commits to log the counters after. */
+    static constexpr uint64_t reportInterval = 1000;
+
+  private:
+    /** @brief Logs the counters, if anything has been committed. */
+    void report() const;
+
+    /** @brief Makes the writes so far durable */
+    Commit commit;
+
+    /** @brief The window to collect writes in */
+    const std::chrono::milliseconds window;
+
+    /** @brief The number of writes not committed yet */
+    size_t pending = 0;
+
+    /** @brief The counters */
+    Stats stats;
+
+    /** @brief Fires when the window closes */
+    std::unique_ptr<
+        sdeventplus::utility::Timer<sdeventplus::ClockId::Monotonic>>
+        windowTimer;
+};
+
+} // namespace logging
+} // namespace phosphor
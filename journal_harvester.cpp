@@ -0,0 +1,123 @@
+#include "journal_harvester.hpp"
+
+#include <phosphor-logging/lg2.hpp>
+
+#include <cstring>
+
+namespace phosphor
+{
+namespace logging
+{
+
+JournalHarvester::~JournalHarvester()
+{
+    if (journal != nullptr)
+    {
+        sd_journal_close(journal);
+    }
+}
+
+bool JournalHarvester::open()
+{
+    if (journal != nullptr)
+    {
+        return true;
+    }
+
+    int rc = sd_journal_open(&journal, SD_JOURNAL_LOCAL_ONLY);
+    if (rc < 0)
+    {
+        lg2::error("Failed to open journal: {ERROR}", "ERROR", strerror(-rc));
+        journal = nullptr;
+        return false;
+    }
+
+    // Requesting the fd sets up the inotify watch that lets
+    // sd_journal_process() notice rotated and newly created journal files,
+    // which a long lived handle would otherwise never look at.
+    rc = sd_journal_get_fd(journal);
+    if (rc < 0)
+    {
+        lg2::info("Unable to watch journal for new files: {ERROR}", "ERROR",
+                  strerror(-rc));
+    }
+
+    return true;
+}
+
+std::vector<std::string>
+    JournalHarvester::harvest(uint64_t transactionId,
+                              std::set<std::string>& metalist)
+{
+    std::vector<std::string> additionalData{};
+
+    if (!open())
+    {
+        return additionalData;
+    }
+
+    // Pick up any journal files added or removed since the last harvest.
+    sd_journal_process(journal);
+
+    // Only entries of this transaction are of interest, so let journald's
+    // field index find them instead of reading every entry in the journal.
+    sd_journal_flush_matches(journal);
+    auto match = "TRANSACTION_ID=" + std::to_string(transactionId);
+    int rc = sd_journal_add_match(journal, match.c_str(), match.size());
+    if (rc < 0)
+    {
+        lg2::error("Failed to add journal match {MATCH}: {ERROR}", "MATCH",
+                   match, "ERROR", strerror(-rc));
+        return additionalData;
+    }
+
+    auto now = std::chrono::duration_cast<std::chrono::microseconds>(
+                   std::chrono::system_clock::now().time_since_epoch())
+                   .count();
+    auto window_us =
+        std::chrono::duration_cast<std::chrono::microseconds>(window).count();
+    uint64_t oldest = (now > window_us) ? now - window_us : 0;
+
+    // Read the journal from the end to get the most recent entry first.
+    // The result from the sd_journal_get_data() is of the form
+    // VARIABLE=value.
+    sd_journal_seek_tail(journal);
+    while (!metalist.empty() && (sd_journal_previous(journal) > 0))
+    {
+        uint64_t timestamp = 0;
+        if ((sd_journal_get_realtime_usec(journal, &timestamp) >= 0) &&
+            (timestamp < oldest))
+        {
+            // Everything from here back is outside of the window.
+            break;
+        }
+
+        // Search for all metadata variables in the current journal entry.
+        for (auto i = metalist.cbegin(); i != metalist.cend();)
+        {
+            const char* data = nullptr;
+            size_t length = 0;
+
+            rc = sd_journal_get_data(journal, (*i).c_str(),
+                                     (const void**)&data, &length);
+            if (rc < 0)
+            {
+                // Metadata variable not found, check next metadata
+                // variable.
+                i++;
+                continue;
+            }
+
+            // Metadata variable found, save it and remove it from the set.
+            additionalData.emplace_back(data, length);
+            i = metalist.erase(i);
+        }
+    }
+
+    sd_journal_flush_matches(journal);
+
+    return additionalData;
+}
+
+} // namespace logging
+} // namespace phosphor
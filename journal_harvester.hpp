@@ -0,0 +1,77 @@
+#pragma once
+
+#include <systemd/sd-journal.h>
+
+#include <chrono>
+#include <cstdint>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace phosphor
+{
+namespace logging
+{
+
+/** @class JournalHarvester
+ *  @brief Collects the metadata of a committed error from the journal.
+ *  @details Keeps a single journal handle open for the lifetime of the
+ *           object and uses journald's field index (a TRANSACTION_ID
+ *           match) to visit only the entries written for the transaction
+ *           being committed, newest first, within a bounded time window.
+ */
+class JournalHarvester
+{
+  public:
+    JournalHarvester(const JournalHarvester&) = delete;
+    JournalHarvester& operator=(const JournalHarvester&) = delete;
+    JournalHarvester(JournalHarvester&&) = delete;
+    JournalHarvester& operator=(JournalHarvester&&) = delete;
+
+    /** @brief Constructor
+     *
+     *  The journal is not opened until the first harvest() call.
+     *
+     *  @param[in] window - How far back in time to look for journal
+     *                      entries of a transaction.
+     */
+    explicit JournalHarvester(
+        std::chrono::seconds window = defaultWindow) : window(window)
+    {}
+
+    ~JournalHarvester();
+
+    /** @brief Read the requested metadata fields of a transaction.
+     *
+     *  @param[in] transactionId - The TRANSACTION_ID of the journal
+     *                             entries to read.
+     *  @param[in,out] metalist - The metadata field names to look for.
+     *                            Fields that are found are removed from
+     *                            the set, so on return it only holds the
+     *                            ones that could not be found.
+     *
+     *  @return The found metadata, in VARIABLE=value format.
+     */
+    std::vector<std::string> harvest(uint64_t transactionId,
+                                     std::set<std::string>& metalist);
+
+    /** @brief The default harvest time window. */
+    static constexpr std::chrono::seconds defaultWindow{
+        std::chrono::minutes{10}};
+
+  private:
+    /** @brief Open the journal if it isn't already.
+     *
+     *  @return bool - true if the journal is open
+     */
+    bool open();
+
+    /** @brief The time window to search back in. */
+    const std::chrono::seconds window;
+
+    /** @brief The journal handle, reused for every harvest. */
+    sd_journal* journal = nullptr;
+};
+
+} // namespace logging
+} // namespace phosphor
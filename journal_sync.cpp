@@ -0,0 +1,370 @@
+#include "config.h"
+
+#include "journal_sync.hpp"
+
+#include <poll.h>
+#include <sys/epoll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+#include <phosphor-logging/lg2.hpp>
+
+#include <csignal>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace phosphor
+{
+namespace logging
+{
+
+JournalSync::~JournalSync()
+{
+    watchSource.reset();
+
+    if (inotifyFD != -1)
+    {
+        if (watchFD != -1)
+        {
+            inotify_rm_watch(inotifyFD, watchFD);
+        }
+        close(inotifyFD);
+    }
+}
+
+uint64_t JournalSync::now()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+std::optional<uint64_t> JournalSync::readSyncedTime() const
+{
+    // If the synced file doesn't exist, a sync request will create it.
+    std::ifstream syncedFile(syncedPath);
+    if (syncedFile.fail())
+    {
+        if (errno != ENOENT)
+        {
+            lg2::error("Failed to open journal synced file {FILENAME}: {ERROR}",
+                       "FILENAME", syncedPath, "ERROR", strerror(errno));
+        }
+        return std::nullopt;
+    }
+
+    std::string timestampStr;
+    std::getline(syncedFile, timestampStr);
+
+    try
+    {
+        return std::stoull(timestampStr);
+    }
+    catch (const std::exception& e)
+    {
+        return std::nullopt;
+    }
+}
+
+bool JournalSync::setup()
+{
+    if (inotifyFD != -1)
+    {
+        return true;
+    }
+
+    inotifyFD = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotifyFD < 0)
+    {
+        lg2::error("Failed to create inotify watch: {ERROR}", "ERROR",
+                   strerror(errno));
+        return false;
+    }
+
+    // journald renames the synced file into place after every sync.
+    watchFD = inotify_add_watch(inotifyFD, runPath.c_str(),
+                                IN_MOVED_TO | IN_DONT_FOLLOW | IN_ONLYDIR);
+    if (watchFD < 0)
+    {
+        lg2::error("Failed to watch journal directory: {PATH}: {ERROR}",
+                   "PATH", runPath, "ERROR", strerror(errno));
+        close(inotifyFD);
+        inotifyFD = -1;
+        return false;
+    }
+
+    watchSource = std::make_unique<sdeventplus::source::IO>(
+        event, inotifyFD, EPOLLIN,
+        std::bind(std::mem_fn(&JournalSync::syncedFileChanged), this,
+                  std::placeholders::_1, std::placeholders::_2,
+                  std::placeholders::_3));
+
+    windowTimer = std::make_unique<
+        sdeventplus::utility::Timer<sdeventplus::ClockId::Monotonic>>(
+        event, std::bind(std::mem_fn(&JournalSync::flush), this));
+
+    timeoutTimer = std::make_unique<
+        sdeventplus::utility::Timer<sdeventplus::ClockId::Monotonic>>(
+        event, std::bind(std::mem_fn(&JournalSync::timeoutExpired), this));
+
+    return true;
+}
+
+bool JournalSync::signalJournald()
+{
+    constexpr auto JOURNAL_UNIT = "systemd-journald.service";
+    auto signal = SIGRTMIN + 1;
+
+    try
+    {
+        auto method = bus.new_method_call(SYSTEMD_BUSNAME, SYSTEMD_PATH,
+                                          SYSTEMD_INTERFACE, "KillUnit");
+        method.append(JOURNAL_UNIT, "main", signal);
+        bus.call_noreply(method);
+    }
+    catch (const sdbusplus::exception_t& e)
+    {
+        lg2::error("Failed to kill journal service: {ERROR}", "ERROR", e);
+        return false;
+    }
+
+    return true;
+}
+
+void JournalSync::request(Callback callback)
+{
+    if (!setup())
+    {
+        // There is no way to tell when journald syncs, so just carry on.
+        callback();
+        return;
+    }
+
+    waiters.push_back({now(), std::move(callback)});
+
+    // If a sync is already in progress, complete() starts the next round
+    // for anyone it doesn't cover.
+    if (!flushInProgress && !windowTimer->isEnabled())
+    {
+        windowTimer->restartOnce(window);
+    }
+}
+
+void JournalSync::flush()
+{
+    if (waiters.empty())
+    {
+        return;
+    }
+
+    // Something else may have synced the journal since the oldest waiter
+    // asked, in which case it doesn't need to be done again.
+    if (auto synced = readSyncedTime();
+        synced && (*synced >= waiters.front().start))
+    {
+        complete(synced);
+        return;
+    }
+
+    flushStart = now();
+    if (!signalJournald())
+    {
+        complete(std::nullopt);
+        return;
+    }
+
+    flushInProgress = true;
+    timeoutTimer->restartOnce(syncTimeout);
+}
+
+void JournalSync::drainEvents()
+{
+    // Throw away everything read since the timestamp is read from the
+    // synced file.
+    constexpr auto maxBytes = 64;
+    uint8_t buffer[maxBytes];
+    while (read(inotifyFD, buffer, maxBytes) > 0)
+        ;
+}
+
+void JournalSync::syncedFileChanged(sdeventplus::source::IO& /*io*/,
+                                    int /*fd*/, uint32_t revents)
+{
+    if (!(revents & EPOLLIN))
+    {
+        return;
+    }
+
+    drainEvents();
+
+    auto synced = readSyncedTime();
+    if (!synced)
+    {
+        return;
+    }
+
+    if ((flushInProgress && (*synced >= flushStart)) ||
+        (!waiters.empty() && (*synced >= waiters.front().start)))
+    {
+        complete(synced);
+    }
+}
+
+void JournalSync::timeoutExpired()
+{
+    lg2::info("Poll timeout ({TIMEOUT}), no new journal synced data",
+              "TIMEOUT", syncTimeout.count());
+
+    complete(std::nullopt);
+}
+
+void JournalSync::complete(std::optional<uint64_t> synced)
+{
+    std::vector<Callback> ready;
+    while (!waiters.empty() &&
+           (!synced || (waiters.front().start <= *synced)))
+    {
+        ready.push_back(std::move(waiters.front().callback));
+        waiters.pop_front();
+    }
+
+    if (flushInProgress && (!synced || (*synced >= flushStart)))
+    {
+        flushInProgress = false;
+        timeoutTimer->setEnabled(false);
+    }
+
+    // Anyone left asked after the last sync was requested.
+    if (!waiters.empty() && !flushInProgress && !windowTimer->isEnabled())
+    {
+        windowTimer->restartOnce(window);
+    }
+
+    // The journal was just synced for each of them, so any sync() they
+    // make can be skipped.
+    for (auto& callback : ready)
+    {
+        try
+        {
+            coalescedSync = true;
+            coalesce(callback);
+        }
+        catch (const std::exception& e)
+        {
+            lg2::error("Journal sync callback threw an exception: {ERROR}",
+                       "ERROR", e);
+        }
+    }
+}
+
+void JournalSync::coalesce(const Callback& work)
+{
+    struct Scope
+    {
+        explicit Scope(JournalSync& js) : js(js)
+        {
+            js.coalesceDepth++;
+        }
+
+        ~Scope()
+        {
+            if (--js.coalesceDepth == 0)
+            {
+                js.coalescedSync = false;
+            }
+        }
+
+        JournalSync& js;
+    } scope{*this};
+
+    work();
+}
+
+void JournalSync::sync()
+{
+    if (coalesceDepth != 0)
+    {
+        if (coalescedSync)
+        {
+            return;
+        }
+
+        // Even if this one fails, the ones after it would fare no better.
+        coalescedSync = true;
+    }
+
+    auto start = now();
+
+    if (!setup())
+    {
+        return;
+    }
+
+    if (!signalJournald())
+    {
+        return;
+    }
+
+    // Let's wait until the synced file shows a time after the request
+    // was made, waiting at most syncTimeout.
+    auto deadline = start + std::chrono::duration_cast<
+                                std::chrono::microseconds>(syncTimeout)
+                                .count();
+    std::optional<uint64_t> synced;
+    while (true)
+    {
+        synced = readSyncedTime();
+        if (synced && (*synced >= start))
+        {
+            break;
+        }
+
+        auto current = now();
+        if (current >= deadline)
+        {
+            lg2::info("Poll timeout ({TIMEOUT}), no new journal synced data",
+                      "TIMEOUT", syncTimeout.count());
+            break;
+        }
+
+        struct pollfd fds = {
+            inotifyFD,
+            POLLIN,
+            0,
+        };
+        auto rc = poll(&fds, 1, (deadline - current + 999) / 1000);
+        if ((rc < 0) && (errno != EINTR))
+        {
+            lg2::error("Failed to add event: {ERROR}", "ERROR",
+                       strerror(errno));
+            break;
+        }
+
+        drainEvents();
+    }
+
+    // The inotify events were consumed here, so resume anyone else this
+    // sync covered from the event loop.
+    if (!waiters.empty() && synced)
+    {
+        completeSource = std::make_unique<sdeventplus::source::Defer>(
+            event, std::bind(std::mem_fn(&JournalSync::resumeWaiters), this,
+                             std::placeholders::_1));
+    }
+}
+
+void JournalSync::resumeWaiters(sdeventplus::source::EventBase& /*source*/)
+{
+    completeSource.reset();
+
+    if (auto synced = readSyncedTime();
+        synced && !waiters.empty() && (*synced >= waiters.front().start))
+    {
+        complete(synced);
+    }
+}
+
+} // namespace logging
+} // namespace phosphor
@@ -0,0 +1,225 @@
+#pragma once
+
+#include <sdbusplus/bus.hpp>
+#include <sdeventplus/clock.hpp>
+#include <sdeventplus/event.hpp>
+#include <sdeventplus/source/event.hpp>
+#include <sdeventplus/source/io.hpp>
+#include <sdeventplus/utility/timer.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <optional>
+
+namespace phosphor
+{
+namespace logging
+{
+
+/** @class JournalSync
+ *  @brief Flushes unwritten journal messages to disk from the event loop.
+ *  @details This does what "journalctl --sync" does: it asks journald to
+ *           sync with the SIGRTMIN+1 signal and then waits for the
+ *           timestamp in journald's synced file to move past the time the
+ *           sync was asked for.
+ *
+ *           Requests that come in within a short window of each other are
+ *           merged into a single flush, and every waiter whose request
+ *           time the new synced timestamp covers is resumed at once.  If
+ *           the synced file already covers a request, for example because
+ *           something else asked journald to sync, no flush is sent at all.
+ *
+ *           Callers that have to finish before they return, like the
+ *           Commit and Create D-Bus methods, can't wait for a request.
+ *           They can share a blocking sync() though: inside coalesce(),
+ *           and inside request() callbacks, only the first sync() flushes.
+ */
+class JournalSync
+{
+  public:
+    JournalSync() = delete;
+    JournalSync(const JournalSync&) = delete;
+    JournalSync& operator=(const JournalSync&) = delete;
+    JournalSync(JournalSync&&) = delete;
+    JournalSync& operator=(JournalSync&&) = delete;
+
+    using Callback = std::function<void()>;
+
+    /** @brief Constructor
+     *
+     *  Nothing is set up on the event loop until the first request.
+     *
+     *  @param[in] bus - The bus to ask systemd to signal journald on.
+     *  @param[in] window - How long to collect requests before flushing.
+     *  @param[in] runPath - journald's runtime directory, which holds the
+     *                       synced file.
+     */
+    explicit JournalSync(
+        sdbusplus::bus_t& bus, std::chrono::milliseconds window = defaultWindow,
+        const std::filesystem::path& runPath = defaultRunPath) :
+        bus(bus), window(window), runPath(runPath),
+        syncedPath(runPath / "synced"), event(sdeventplus::Event::get_default())
+    {}
+
+    virtual ~JournalSync();
+
+    /** @brief Asynchronously wait for everything logged so far to be
+     *         on disk.
+     *
+     *  The callback is run from the event loop once the journal has been
+     *  synced, or once the sync has timed out.
+     *
+     *  @param[in] callback - The function to call when done.
+     */
+    void request(Callback callback);
+
+    /** @brief Synchronously wait for everything logged so far to be on
+     *         disk, for callers that can't be resumed from the event loop.
+     *
+     *  Blocks for at most syncTimeout.  Any asynchronous requests that the
+     *  resulting sync covers are resumed on the next event loop iteration.
+     *
+     *  Returns right away if the journal was already synced for the
+     *  coalesce() call or request() callback this is made from.
+     */
+    void sync();
+
+    /** @brief Runs work that may sync the journal several times, such as
+     *         creating a batch of entries that each get a PEL, with just
+     *         the first sync() flushing.
+     *
+     *  The later ones are covered, as everything they need synced was
+     *  logged before the work started.
+     *
+     *  @param[in] work - The function to run
+     */
+    void coalesce(const Callback& work);
+
+    /** @brief The default window to merge requests in. */
+    static constexpr std::chrono::milliseconds defaultWindow{10};
+
+    /** @brief How long to wait for journald to finish a sync. */
+    static constexpr std::chrono::seconds syncTimeout{5};
+
+    /** @brief Where journald writes the synced file */
+    static constexpr auto defaultRunPath = "/run/systemd/journal";
+
+  protected:
+    /** @brief Returns the current steady clock time in usecs, which is the
+     *         clock journald writes into the synced file. */
+    static uint64_t now();
+
+    /** @brief Asks systemd to send journald the sync signal.
+     *
+     *  @return bool - If the request was sent
+     */
+    virtual bool signalJournald();
+
+  private:
+    /** @brief A request waiting for the journal to be synced. */
+    struct Waiter
+    {
+        /** @brief When the request was made, in steady clock usecs */
+        uint64_t start;
+
+        /** @brief The function to call when done */
+        Callback callback;
+    };
+
+    /** @brief Creates the inotify watch and event sources, if not done
+     *         already.
+     *
+     *  @return bool - If the watch could be set up
+     */
+    bool setup();
+
+    /** @brief Reads the timestamp of the last sync from the synced file.
+     *
+     *  @return The timestamp, or an empty optional if there isn't one.
+     */
+    std::optional<uint64_t> readSyncedTime() const;
+
+    /** @brief Called when the request window expires to start a sync. */
+    void flush();
+
+    /** @brief Called when the journald runtime directory changes. */
+    void syncedFileChanged(sdeventplus::source::IO& io, int fd,
+                           uint32_t revents);
+
+    /** @brief Called when journald didn't sync within syncTimeout. */
+    void timeoutExpired();
+
+    /** @brief Reads and throws away pending inotify events. */
+    void drainEvents();
+
+    /** @brief Resumes waiters covered by a blocking sync(). */
+    void resumeWaiters(sdeventplus::source::EventBase& source);
+
+    /** @brief Resumes the waiters covered by the synced timestamp and
+     *         starts another round if any are left.
+     *
+     *  @param[in] synced - The synced timestamp, or an empty optional to
+     *                      resume every waiter.
+     */
+    void complete(std::optional<uint64_t> synced);
+
+    /** @brief The bus connection */
+    sdbusplus::bus_t& bus;
+
+    /** @brief The window to merge requests in */
+    const std::chrono::milliseconds window;
+
+    /** @brief journald's runtime directory */
+    const std::filesystem::path runPath;
+
+    /** @brief The file journald writes the time of the last sync to */
+    const std::filesystem::path syncedPath;
+
+    /** @brief The event loop */
+    sdeventplus::Event event;
+
+    /** @brief Outstanding requests, oldest first */
+    std::deque<Waiter> waiters;
+
+    /** @brief If a sync has been asked of journald and not seen yet */
+    bool flushInProgress = false;
+
+    /** @brief When the sync in progress was asked for */
+    uint64_t flushStart = 0;
+
+    /** @brief How deep the coalesce() calls in progress are nested */
+    unsigned coalesceDepth = 0;
+
+    /** @brief If the journal was synced since the outermost coalesce()
+     *         call started */
+    bool coalescedSync = false;
+
+    /** @brief Fires when the request window closes */
+    std::unique_ptr<
+        sdeventplus::utility::Timer<sdeventplus::ClockId::Monotonic>>
+        windowTimer;
+
+    /** @brief Fires if journald doesn't sync in time */
+    std::unique_ptr<
+        sdeventplus::utility::Timer<sdeventplus::ClockId::Monotonic>>
+        timeoutTimer;
+
+    /** @brief Watches the synced file for updates */
+    std::unique_ptr<sdeventplus::source::IO> watchSource;
+
+    /** @brief Resumes waiters after a blocking sync() */
+    std::unique_ptr<sdeventplus::source::Defer> completeSource;
+
+    /** @brief The inotify file descriptor */
+    int inotifyFD = -1;
+
+    /** @brief The inotify watch descriptor */
+    int watchFD = -1;
+};
+
+} // namespace logging
+} // namespace phosphor
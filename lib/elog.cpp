@@ -1,8 +1,10 @@
 #include "config.h"
 
 #include <phosphor-logging/elog.hpp>
+#include <sdbusplus/bus/match.hpp>
 
 #include <stdexcept>
+#include <string>
 
 namespace phosphor
 {
@@ -58,5 +60,57 @@ uint32_t commit(std::string&& name)
     return phosphor::logging::details::commit(name.c_str());
 }
 
+bool waitForEntry(uint32_t entryID, std::chrono::milliseconds timeout)
+{
+    auto bus = sdbusplus::bus::new_default();
+    return waitForEntry(bus, BUSNAME_LOGGING, entryID, timeout);
+}
+
+bool waitForEntry(sdbusplus::bus_t& bus, const std::string& service,
+                  uint32_t entryID, std::chrono::milliseconds timeout)
+{
+    using namespace sdbusplus::bus::match::rules;
+
+    auto path = std::string(OBJ_ENTRY) + '/' + std::to_string(entryID);
+    bool found = false;
+
+    // Start watching before checking if the entry is already there so
+    // that it can't be created in between without being noticed.
+    sdbusplus::bus::match_t match(
+        bus, interfacesAdded(OBJ_LOGGING) + argNpath(0, path),
+        [&found](sdbusplus::message_t&) { found = true; });
+
+    try
+    {
+        auto method = bus.new_method_call(service.c_str(), path.c_str(),
+                                          "org.freedesktop.DBus.Properties",
+                                          "Get");
+        method.append("xyz.openbmc_project.Logging.Entry", "Id");
+        bus.call(method);
+        found = true;
+    }
+    catch (const sdbusplus::exception_t&)
+    {
+        // Not created yet
+    }
+
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (!found)
+    {
+        auto now = std::chrono::steady_clock::now();
+        if (now >= deadline)
+        {
+            break;
+        }
+
+        bus.wait(
+            std::chrono::duration_cast<std::chrono::microseconds>(deadline -
+                                                                  now));
+        bus.process_discard();
+    }
+
+    return found;
+}
+
 } // namespace logging
 } // namespace phosphor
@@ -2,8 +2,11 @@
 #include "xyz/openbmc_project/Logging/Entry/server.hpp"
 
 #include <phosphor-logging/log.hpp>
+#include <sdbusplus/bus.hpp>
 #include <sdbusplus/exception.hpp>
 
+#include <chrono>
+#include <string>
 #include <tuple>
 #include <utility>
 
@@ -232,6 +235,39 @@ uint32_t report(Entry::Level level, Args... i_args)
     return commit<T>(level);
 }
 
+/** @fn waitForEntry()
+ *  @brief Wait for a committed entry to be created.
+ *  @details When the logging service commits asynchronously, commit()
+ *           returns as soon as the entry ID has been reserved.  The entry
+ *           D-Bus object is only put on the bus once the journal metadata
+ *           has been collected, and the extensions are told about it
+ *           before the service handles another request, so once it
+ *           appears it can be used like any other entry.  It is written
+ *           to flash a little later, from the service's event loop.  With
+ *           synchronous commits this returns right away.
+ *  @param[in] entryID - The ID returned by commit()
+ *  @param[in] timeout - How long to wait for it
+ *
+ *  @return bool - true if the entry exists, false if it didn't show up
+ *                 before the timeout.
+ */
+bool waitForEntry(uint32_t entryID, std::chrono::milliseconds timeout =
+                                        std::chrono::seconds{10});
+
+/** @fn waitForEntry()
+ *  @brief Wait for a committed entry to be created, on the bus connection
+ *         and from the service passed in.
+ *  @param[in] bus - The bus connection to wait on
+ *  @param[in] service - The logging service's bus name
+ *  @param[in] entryID - The ID returned by commit()
+ *  @param[in] timeout - How long to wait for it
+ *
+ *  @return bool - true if the entry exists, false if it didn't show up
+ *                 before the timeout.
+ */
+bool waitForEntry(sdbusplus::bus_t& bus, const std::string& service,
+                  uint32_t entryID, std::chrono::milliseconds timeout);
+
 } // namespace logging
 
 } // namespace phosphor
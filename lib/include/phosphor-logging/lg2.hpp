@@ -9,7 +9,13 @@
 #include <phosphor-logging/lg2/flags.hpp>
 #include <phosphor-logging/lg2/header.hpp>
 #include <phosphor-logging/lg2/level.hpp>
+#include <phosphor-logging/lg2/logger.hpp>
+#include <phosphor-logging/lg2/message.hpp>
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <source_location>
 
 namespace lg2
@@ -24,12 +30,22 @@ struct log
      *  @param[in] msg - The message to log.
      *  @param[in] ts - The rest of the arguments.
      */
-    explicit log(const std::source_location& s, const char* msg,
-                 details::header_str_conversion_t<Ts&&>... ts)
+    explicit log([[maybe_unused]] const std::source_location& s,
+                 [[maybe_unused]] const details::message_str& msg,
+                 [[maybe_unused]] details::header_str_conversion_t<Ts&&>... ts)
     {
-        details::log_conversion::start(
-            S, s, msg,
-            std::forward<details::header_str_conversion_t<Ts&&>>(ts)...);
+        // Check the level before doing any of the work to format the fields,
+        // so that disabled calls cost no more than a load and compare.
+        if constexpr (static_cast<int>(S) <= PHOSPHOR_LOG2_MAX_LEVEL)
+        {
+            if (details::enabled(S))
+            {
+                details::log_conversion::start(
+                    S, s, msg,
+                    std::forward<details::header_str_conversion_t<Ts&&>>(
+                        ts)...);
+            }
+        }
     }
 
     /** default log (source_location is determined by calling location).
@@ -39,7 +55,8 @@ struct log
      *  @param[in] s - The derived source_location.
      */
     explicit log(
-        const char* msg, details::header_str_conversion_t<Ts&&>... ts,
+        const details::message_str& msg,
+        details::header_str_conversion_t<Ts&&>... ts,
         const std::source_location& s = std::source_location::current()) :
         log(s, msg, std::forward<details::header_str_conversion_t<Ts&&>>(ts)...)
     {}
@@ -106,6 +123,147 @@ PHOSPHOR_LOG2_DECLARE_LEVEL(debug);
     PHOSPHOR_LOG2_USING;                                                       \
     PHOSPHOR_LOG2_USING_FLAGS
 
+namespace details
+{
+
+/** Log how many messages a rate limited call site suppressed.
+ *
+ *  @param[in] l - The level of the call site.
+ *  @param[in] s - The source location of the call site.
+ *  @param[in] count - How many messages were suppressed.
+ */
+void log_suppressed(level l, const std::source_location& s, uint64_t count);
+
+} // namespace details
+
+/** Token bucket limiting how many messages a call site logs.
+ *
+ *  This is the generic cell rate algorithm, which keeps the whole bucket in
+ *  one timestamp so that it can be shared between threads without a lock.
+ *  Use it through PHOSPHOR_LOG2_RATELIMITED.
+ */
+class ratelimit
+{
+  public:
+    /** Constructor.
+     *
+     *  @param[in] burst - The most messages logged in a period.
+     *  @param[in] period - The period the messages are spread over.
+     */
+    ratelimit(uint64_t burst, std::chrono::nanoseconds period) :
+        interval(period.count() /
+                 static_cast<int64_t>(std::max<uint64_t>(burst, 1))),
+        tolerance(period.count() - interval)
+    {}
+
+    /** Check if a message at a level may be logged now.
+     *
+     *  When it may, and earlier ones were suppressed, this first logs how
+     *  many were.
+     *
+     *  @param[in] s - The source location of the call site.
+     *  @param[in] now - The current steady_clock time.
+     */
+    template <level S>
+    bool allow(const std::source_location& s,
+               std::chrono::nanoseconds now = steady_now())
+    {
+        if constexpr (static_cast<int>(S) > PHOSPHOR_LOG2_MAX_LEVEL)
+        {
+            return false;
+        }
+        else
+        {
+            // Don't use up the bucket on messages which wouldn't be logged.
+            if (!details::enabled(S))
+            {
+                return false;
+            }
+
+            if (!take(now.count()))
+            {
+                suppressed.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+
+            if (auto count = suppressed.exchange(0, std::memory_order_relaxed);
+                count != 0)
+            {
+                details::log_suppressed(S, s, count);
+            }
+            return true;
+        }
+    }
+
+    /** Get how many messages were suppressed since the last one allowed. */
+    uint64_t suppressed_count() const
+    {
+        return suppressed.load(std::memory_order_relaxed);
+    }
+
+  private:
+    /** Get the current steady_clock time. */
+    static std::chrono::nanoseconds steady_now()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch());
+    }
+
+    /** Take a token from the bucket, if it has one.
+     *
+     *  @param[in] now - The current time, in nanoseconds.
+     */
+    bool take(int64_t now)
+    {
+        auto current = tat.load(std::memory_order_relaxed);
+        while (true)
+        {
+            auto start = std::max(current, now);
+            if (start - now > tolerance)
+            {
+                return false;
+            }
+            if (tat.compare_exchange_weak(current, start + interval,
+                                          std::memory_order_relaxed))
+            {
+                return true;
+            }
+        }
+    }
+
+    // Nanoseconds each message uses up.
+    const int64_t interval;
+    // How far ahead of now the bucket may be drawn down.
+    const int64_t tolerance;
+    // When the bucket will be full again (the "theoretical arrival time").
+    std::atomic<int64_t> tat{0};
+    // Messages suppressed since the last one logged.
+    std::atomic<uint64_t> suppressed{0};
+};
+
+/** Log from a call site at most `burst` times every `period`.
+ *
+ *  Messages past the limit are dropped, and when the call site is allowed to
+ *  log again a message says how many were.  For example:
+ *
+ *      PHOSPHOR_LOG2_RATELIMITED(10, 1s, error, "pldm_recv failed", "RC", rc);
+ *
+ *  @param[in] burst - The most messages logged in a period.
+ *  @param[in] period - A std::chrono duration for the period.
+ *  @param[in] lvl - The level name, such as `error`.
+ *  @param[in] ... - The message and fields, as for `lg2::lvl`.
+ */
+#define PHOSPHOR_LOG2_RATELIMITED(burst, period, lvl, ...)                     \
+    do                                                                         \
+    {                                                                          \
+        static lg2::ratelimit lg2_ratelimit(burst, period);                    \
+        if (lg2_ratelimit.allow<lg2::level::lvl>(                              \
+                std::source_location::current()))                              \
+        {                                                                      \
+            lg2::lvl(__VA_ARGS__);                                             \
+        }                                                                      \
+    } while (0)
+
 } // namespace lg2
 
 #endif
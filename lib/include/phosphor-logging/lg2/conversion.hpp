@@ -4,6 +4,7 @@
 #include <phosphor-logging/lg2/header.hpp>
 #include <phosphor-logging/lg2/level.hpp>
 #include <phosphor-logging/lg2/logger.hpp>
+#include <phosphor-logging/lg2/message.hpp>
 #include <sdbusplus/message/native_types.hpp>
 
 #include <concepts>
@@ -286,10 +287,11 @@ class log_conversion
     /** Conversion and validation is complete.  Pass along to the final
      *  do_log variadic function. */
     template <typename... Ts>
-    static void done(level l, const std::source_location& s, const char* m,
+    static void done(level l, const std::source_location& s,
+                     const message_str& m,
                      Ts&&... ts)
     {
-        do_log(l, s, m, ts..., nullptr);
+        do_log(l, s, &m, ts..., nullptr);
     }
 
     /** Apply the tuple from the end of 'step' into done.
@@ -398,8 +400,8 @@ class log_conversion
     /** Start processing a sequence of arguments to `lg2::log` using `step` or
      * `done`. */
     template <typename... Ts>
-    static void start(level l, const std::source_location& s, const char* msg,
-                      Ts&&... ts)
+    static void start(level l, const std::source_location& s,
+                      const message_str& msg, Ts&&... ts)
     {
         // If there are no arguments (ie. just a message), then skip processing
         // and call `done` directly.
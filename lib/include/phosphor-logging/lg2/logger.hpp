@@ -1,12 +1,82 @@
 #pragma once
 
 #include <phosphor-logging/lg2/level.hpp>
+#include <phosphor-logging/lg2/message.hpp>
 
+#include <atomic>
 #include <cstddef>
 #include <source_location>
 
-namespace lg2::details
+/** The least severe level which is compiled in.
+ *
+ *  Calls to `lg2::log` at a less severe level than this (a larger syslog
+ *  priority) compile down to nothing, other than evaluating their arguments.
+ *  To use it, define it to a syslog priority, such as `LOG_INFO`, on the
+ *  compiler command line so that every translation unit of the program sees
+ *  the same value.
+ */
+#ifndef PHOSPHOR_LOG2_MAX_LEVEL
+#define PHOSPHOR_LOG2_MAX_LEVEL LOG_DEBUG
+#endif
+
+namespace lg2
+{
+
+/** Set the least severe level which is logged by this process.
+ *
+ *  This overrides the level from `LG2_LEVEL` or the lg2 config file.
+ *
+ *  @param[in] l - The new threshold.
+ */
+void set_threshold(level l);
+
+/** Get the least severe level which is logged by this process. */
+level get_threshold();
+
+/** What the asynchronous journal sink does when its queue is full. */
+enum class overflow_policy
+{
+    /** Discard the oldest queued message to make room. */
+    drop_oldest,
+    /** Wait for there to be room. */
+    block,
+    /** Discard the new message. */
+    count_dropped,
+};
+
+/** Send messages to the journal from a background thread.
+ *
+ *  Log calls then only copy their message into a queue, so they don't wait
+ *  on journald.  Messages at `critical` or more severe are still sent right
+ *  away, after everything queued before them.  Any messages that are dropped
+ *  are counted and reported in a later message.  The queue is flushed when
+ *  the process exits.
+ *
+ *  This can also be turned on by setting `LG2_ASYNC`.  Calls after the first
+ *  do nothing.
+ *
+ *  @param[in] policy - What to do when the queue is full.
+ */
+void enable_async(overflow_policy policy = overflow_policy::count_dropped);
+
+/** Send any messages queued by the asynchronous sink from this thread. */
+void flush();
+
+namespace details
+{
+
+/** The least severe level which is logged, as a syslog priority.
+ *
+ *  Starts out at `LOG_DEBUG` so nothing is dropped until the library has read
+ *  the process's configured threshold.
+ */
+extern std::atomic<int> threshold;
+
+/** Check if messages of a level are being logged by this process. */
+inline bool enabled(level l)
 {
+    return static_cast<int>(l) <= threshold.load(std::memory_order_relaxed);
+}
 
 /** Low-level function that actually performs the logging.
  *
@@ -18,8 +88,9 @@ namespace lg2::details
  *  @param[in] level - The logging level to use.
  *  @param[in] source_location - The original source location of the upper-level
  *                               log call.
- *  @param[in] char* - The primary message to log.
+ *  @param[in] message_str - The primary message to log.
  */
-void do_log(level, const std::source_location&, const char*, ...);
+void do_log(level, const std::source_location&, const message_str*, ...);
 
-} // namespace lg2::details
+} // namespace details
+} // namespace lg2
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <phosphor-logging/lg2/concepts.hpp>
+
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace lg2::details
+{
+
+/** A type to hold the message of a log call, along with where its {HEADER}
+ *  placeholders are.
+ *
+ *  When the message is a string literal, as it nearly always is, the
+ *  placeholders are found at compile time so `do_log` can render the message
+ *  in one pass without searching it.  A message given as a pointer is
+ *  searched for placeholders at runtime instead.
+ *
+ *  Any `const char` array is taken to be constant, so an array which isn't a
+ *  constant expression, such as a local `const char msg[]` or a struct
+ *  member, fails to compile as a message.  Pass a pointer to it instead, as
+ *  in `lg2::info(std::data(msg))`.
+ */
+struct message_str
+{
+    /** Location of a {HEADER} placeholder in the message. */
+    struct placeholder
+    {
+        // Offset of the '{'.
+        uint16_t start;
+        // Size including both braces.
+        uint16_t size;
+    };
+
+    /** Most placeholders a message can have and still be parsed at compile
+     *  time. */
+    static constexpr size_t max_placeholders = 8;
+
+    // Hold the message string value.
+    std::string_view value;
+
+    // The placeholders, in the order they appear, if 'parsed'.
+    std::array<placeholder, max_placeholders> placeholders{};
+    uint8_t count = 0;
+    bool parsed = false;
+
+    // Set if the message is a string literal, rather than only known at
+    // runtime.
+    bool constant = false;
+
+    /** Constructor for constant messages, which finds the placeholders.
+     *
+     *  An error here that the message "is not usable in a constant
+     *  expression" means it must be passed as a pointer.
+     */
+    template <maybe_constexpr_string T>
+    consteval message_str(T&& s) : value(s), constant(true)
+    {
+        if (value.size() > UINT16_MAX)
+        {
+            return;
+        }
+
+        for (size_t pos = 0; pos < value.size();)
+        {
+            auto open = value.find('{', pos);
+            auto close = value.find('}', open);
+            if (close == std::string_view::npos)
+            {
+                break;
+            }
+
+            // Only something which could be a header is a placeholder; keep
+            // looking after the brace otherwise.
+            auto header = value.substr(open + 1, close - open - 1);
+            auto invalid = header.find_first_not_of(
+                "ABCDEFGHIJKLMNOPQRSTUVWXYZ_0123456789");
+            if (header.empty() || (invalid != std::string_view::npos))
+            {
+                pos = open + 1;
+                continue;
+            }
+
+            if (count == max_placeholders)
+            {
+                return;
+            }
+            placeholders[count++] = {static_cast<uint16_t>(open),
+                                     static_cast<uint16_t>(close - open + 1)};
+            pos = close + 1;
+        }
+
+        parsed = true;
+    }
+
+    /** Constructor for messages only known at runtime. */
+    template <not_constexpr_string T>
+        requires std::convertible_to<T, const char*>
+    message_str(T&& s) : value(s)
+    {}
+
+    const char* data() const
+    {
+        return value.data();
+    }
+};
+
+} // namespace lg2::details
@@ -21,8 +21,15 @@
 #include <phosphor-logging/sdjournal.hpp>
 #include <sdbusplus/server/transaction.hpp>
 
+#include <array>
+#include <charconv>
+#include <cstdarg>
+#include <cstdio>
+#include <string>
+#include <string_view>
 #include <tuple>
 #include <type_traits>
+#include <utility>
 
 namespace phosphor
 {
@@ -48,47 +55,103 @@ enum class level
 namespace details
 {
 
-/** @fn prio()
- *  @brief Prepend PRIORITY= to the input priority string.
- *    This is required by sd_journal_send().
+/** @brief The PRIORITY field of a level.
+ *    It is formatted at compile time, so every call at a level sends the
+ *    same static string.
  *  @tparam L - Priority level
  */
 template <level L>
-constexpr auto prio()
-{
-    constexpr const char* prio_str = "PRIORITY=%d";
-    constexpr const auto prio_tuple = std::make_tuple(prio_str, L);
-    return prio_tuple;
-}
-
-/** @fn helper_log()
- *  @brief Helper function for details::log(). Log request to journal.
- *  @tparam T - Type of tuple
- *  @tparam I - std::integer_sequence of indexes (0..N) for each tuple element
- *  @param[in] e - Tuple containing the data to be logged
- *  @param[unnamed] - std::integer_sequence of tuple's index values
+constexpr std::array<char, 10> prio_field = {
+    'P', 'R', 'I', 'O', 'R', 'I', 'T', 'Y', '=',
+    static_cast<char>('0' + static_cast<int>(L))};
+
+/** @fn format_field()
+ *  @brief Format a field the way sd_journal_send() formats each of its
+ *    format strings.
+ *  @param[out] buf - The buffer to format into.
+ *  @param[in] size - The size of the buffer.
+ *  @param[in] fmt - The printf-style format string.
+ *  @return the size of the whole field, even if it didn't fit, or a
+ *    negative value on error.
  */
-template <typename T, size_t... I>
-void helper_log(T&& e, std::integer_sequence<size_t, I...>)
+inline int format_field(char* buf, size_t size, const char* fmt, ...)
 {
-    // https://www.freedesktop.org/software/systemd/man/sd_journal_print.html
-    // TODO: Re-enable call through interface for testing (or move the code
-    // into the body of the object).
-    sd_journal_send(std::get<I>(std::forward<T>(e))..., NULL);
+    va_list args;
+    va_start(args, fmt);
+    int rc = vsnprintf(buf, size, fmt, args);
+    va_end(args);
+    return rc;
 }
 
-/** @fn details::log()
- *  @brief Implementation of logging::log() function.
- *         Send request msg and size to helper funct to log it to the journal.
- *  @tparam T - Type of tuple
- *  @param[in] e - Tuple containing the data to be logged
+/** @class field
+ *  @brief A journal field built for one log call.
+ *  @details Fields which fit in the inline buffer, as nearly all do, are
+ *    built without allocating.
  */
-template <typename T>
-void log(T&& e)
+class field
 {
-    constexpr auto e_size = std::tuple_size<std::decay_t<T>>::value;
-    helper_log(std::forward<T>(e), std::make_index_sequence<e_size>{});
-}
+  public:
+    /** @brief Build a field from a key, like "MESSAGE=", and a value. */
+    field(std::string_view key, std::string_view value) :
+        size(key.size() + value.size())
+    {
+        if (size <= inline_data.size())
+        {
+            data = inline_data.data();
+        }
+        else
+        {
+            heap.resize(size);
+            data = heap.data();
+        }
+        key.copy(data, key.size());
+        value.copy(data + key.size(), value.size());
+    }
+
+    /** @brief Build a field from the format string and arguments of an
+     *    entry().
+     *  @param[in] e - Tuple from entry()
+     *  @param[unnamed] - std::integer_sequence of tuple's index values
+     */
+    template <typename T, size_t... I>
+    field(const T& e, std::integer_sequence<size_t, I...>)
+    {
+        int rc = format_field(inline_data.data(), inline_data.size(),
+                              std::get<I>(e)...);
+        if (rc < 0)
+        {
+            return;
+        }
+        size = rc;
+
+        if (size < inline_data.size())
+        {
+            data = inline_data.data();
+            return;
+        }
+
+        // Too big for the inline buffer, so format it again into the heap,
+        // with room for the NUL.
+        heap.resize(size + 1);
+        format_field(heap.data(), heap.size(), std::get<I>(e)...);
+        heap.resize(size);
+        data = heap.data();
+    }
+
+    field(const field&) = delete;
+    field& operator=(const field&) = delete;
+
+    iovec iov()
+    {
+        return {data, size};
+    }
+
+  private:
+    std::array<char, 256> inline_data;
+    std::string heap;
+    char* data = nullptr;
+    size_t size = 0;
+};
 
 } // namespace details
 
@@ -159,16 +222,32 @@ void log(Msg msg, Entry... e)
                    std::is_same<char*, std::decay_t<Msg>>::value),
                   "First parameter must be a C-string.");
 
-    constexpr const char* msg_str = "MESSAGE=%s";
-    const auto msg_tuple = std::make_tuple(msg_str, std::forward<Msg>(msg));
+    details::field message("MESSAGE=", msg != nullptr ? msg : "(null)");
+
+    std::array<char, 20> id;
+    auto id_end = std::to_chars(id.data(), id.data() + id.size(),
+                                sdbusplus::server::transaction::get_id())
+                      .ptr;
+    details::field transaction("TRANSACTION_ID=",
+                               {id.data(), static_cast<size_t>(
+                                               id_end - id.data())});
+
+    // Only the entries need printf-style formatting.
+    std::array<details::field, sizeof...(Entry)> entries{details::field(
+        e, std::make_index_sequence<std::tuple_size<Entry>::value>{})...};
+
+    const auto& prio = details::prio_field<L>;
+    std::array<iovec, 3 + sizeof...(Entry)> iov{
+        {{const_cast<char*>(prio.data()), prio.size()},
+         message.iov(),
+         transaction.iov()}};
+    for (size_t i = 0; i < entries.size(); ++i)
+    {
+        iov[3 + i] = entries[i].iov();
+    }
 
-    constexpr auto transactionStr = "TRANSACTION_ID=%llu";
-    auto transactionId = sdbusplus::server::transaction::get_id();
-
-    auto log_tuple = std::tuple_cat(details::prio<L>(), msg_tuple,
-                                    entry(transactionStr, transactionId),
-                                    std::forward<Entry>(e)...);
-    details::log(log_tuple);
+    // https://www.freedesktop.org/software/systemd/man/sd_journal_print.html
+    sd_journal_sendv(iov.data(), iov.size());
 }
 
 } // namespace logging
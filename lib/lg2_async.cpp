@@ -0,0 +1,435 @@
+#define SD_JOURNAL_SUPPRESS_LOCATION
+
+#include "lg2_async.hpp"
+
+#include <pthread.h>
+#include <systemd/sd-journal.h>
+
+#include <phosphor-logging/lg2/logger.hpp>
+
+#include <array>
+#include <atomic>
+#include <cinttypes>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <string_view>
+#include <thread>
+
+namespace lg2::details
+{
+
+/** Bounded queue of journal records.
+ *
+ *  This is Vyukov's bounded MPMC queue: each record has a sequence number
+ *  which says whether it is free for the producer at that position or full
+ *  for the consumer at it, so pushing and popping each only take a CAS on
+ *  the tail or head.  Allowing more than one consumer is what lets
+ *  producers drop the oldest record and flush the queue themselves.
+ */
+class record_queue
+{
+  public:
+    /** Most fields in a queued record. */
+    static constexpr size_t max_fields = 32;
+
+    /** Most bytes of field data in a queued record. */
+    static constexpr size_t max_bytes = 2048;
+
+    /** Number of records the queue holds; must be a power of two. */
+    static constexpr size_t capacity = 128;
+
+    struct record
+    {
+        std::atomic<size_t> sequence;
+        size_t count;
+        std::array<uint16_t, max_fields> ends;
+        std::array<char, max_bytes> data;
+    };
+
+    record_queue()
+    {
+        for (size_t i = 0; i < capacity; ++i)
+        {
+            records[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    /** Check if a set of fields fits in a record. */
+    static bool fits(const iovec* iov, size_t count)
+    {
+        if (count > max_fields)
+        {
+            return false;
+        }
+
+        size_t size = 0;
+        for (size_t i = 0; i < count; ++i)
+        {
+            size += iov[i].iov_len;
+        }
+        return size <= max_bytes;
+    }
+
+    /** Copy a set of fields, which must fit, into the queue.
+     *
+     *  @return false if the queue is full.
+     */
+    bool try_push(const iovec* iov, size_t count)
+    {
+        auto pos = tail.load(std::memory_order_relaxed);
+        record* r = nullptr;
+        while (true)
+        {
+            r = &records[pos & (capacity - 1)];
+            auto seq = r->sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (diff == 0)
+            {
+                if (tail.compare_exchange_weak(pos, pos + 1,
+                                               std::memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            else if (diff < 0)
+            {
+                return false;
+            }
+            else
+            {
+                pos = tail.load(std::memory_order_relaxed);
+            }
+        }
+
+        size_t end = 0;
+        for (size_t i = 0; i < count; ++i)
+        {
+            memcpy(r->data.data() + end, iov[i].iov_base, iov[i].iov_len);
+            end += iov[i].iov_len;
+            r->ends[i] = end;
+        }
+        r->count = count;
+
+        r->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    /** Take the oldest record out of the queue, calling f with it.
+     *
+     *  @return false if the queue is empty.
+     */
+    template <typename F>
+    bool try_pop(F&& f)
+    {
+        auto pos = head.load(std::memory_order_relaxed);
+        record* r = nullptr;
+        while (true)
+        {
+            r = &records[pos & (capacity - 1)];
+            auto seq = r->sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<intptr_t>(seq) -
+                        static_cast<intptr_t>(pos + 1);
+            if (diff == 0)
+            {
+                if (head.compare_exchange_weak(pos, pos + 1,
+                                               std::memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            else if (diff < 0)
+            {
+                return false;
+            }
+            else
+            {
+                pos = head.load(std::memory_order_relaxed);
+            }
+        }
+
+        f(*r);
+
+        r->sequence.store(pos + capacity, std::memory_order_release);
+        return true;
+    }
+
+  private:
+    std::array<record, capacity> records;
+    alignas(64) std::atomic<size_t> head{0};
+    alignas(64) std::atomic<size_t> tail{0};
+};
+
+/** Send a queued record to the journal. */
+static void send_record(const record_queue::record& r)
+{
+    std::array<iovec, record_queue::max_fields> iov;
+    size_t start = 0;
+    for (size_t i = 0; i < r.count; ++i)
+    {
+        iov[i] = {const_cast<char*>(r.data.data()) + start, r.ends[i] - start};
+        start = r.ends[i];
+    }
+    sd_journal_sendv(iov.data(), r.count);
+}
+
+/** Journal sink which hands records to a background thread to send. */
+class async_sink
+{
+  public:
+    explicit async_sink(overflow_policy policy) :
+        policy(policy), thread(&async_sink::run, this)
+    {}
+
+    async_sink(const async_sink&) = delete;
+    async_sink& operator=(const async_sink&) = delete;
+
+    /** Queue a record.
+     *
+     *  @return false if the caller needs to send it itself.
+     */
+    bool send(const iovec* iov, size_t count)
+    {
+        if (!record_queue::fits(iov, count))
+        {
+            return false;
+        }
+
+        while (!queue.try_push(iov, count))
+        {
+            if (stopping.load(std::memory_order_relaxed))
+            {
+                return false;
+            }
+
+            switch (policy)
+            {
+                case overflow_policy::drop_oldest:
+                {
+                    if (queue.try_pop([](const auto&) {}))
+                    {
+                        dropped.fetch_add(1, std::memory_order_relaxed);
+                    }
+                    break;
+                }
+
+                case overflow_policy::block:
+                {
+                    wake();
+                    std::this_thread::yield();
+                    break;
+                }
+
+                case overflow_policy::count_dropped:
+                {
+                    dropped.fetch_add(1, std::memory_order_relaxed);
+                    wake();
+                    return true;
+                }
+            }
+        }
+
+        wake();
+        return true;
+    }
+
+    /** Send everything in the queue from the calling thread. */
+    void flush()
+    {
+        while (queue.try_pop(send_record))
+        {}
+    }
+
+    /** Stop the thread once it has sent everything in the queue. */
+    void stop()
+    {
+        if (stopping.exchange(true))
+        {
+            return;
+        }
+
+        idle.store(false);
+        wakeups.fetch_add(1, std::memory_order_release);
+        wakeups.notify_one();
+        thread.join();
+    }
+
+  private:
+    /** Wake the thread if it is waiting for records. */
+    void wake()
+    {
+        // Pairs with the fence in run() so that either the thread sees the
+        // record that was just pushed or this sees that it is idle.
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (idle.load(std::memory_order_relaxed) && idle.exchange(false))
+        {
+            wakeups.fetch_add(1, std::memory_order_release);
+            wakeups.notify_one();
+        }
+    }
+
+    /** Send all the queued records in a batch, then wait for more. */
+    void run()
+    {
+        while (true)
+        {
+            auto seen = wakeups.load(std::memory_order_acquire);
+
+            flush();
+            report_dropped();
+
+            if (stopping.load())
+            {
+                break;
+            }
+
+            idle.store(true);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (queue.try_pop(send_record))
+            {
+                idle.store(false);
+                continue;
+            }
+
+            wakeups.wait(seen, std::memory_order_acquire);
+        }
+
+        flush();
+        report_dropped();
+    }
+
+    /** Log how many records were dropped since the last report, if any. */
+    void report_dropped()
+    {
+        auto count = dropped.exchange(0, std::memory_order_relaxed);
+        if (count == 0)
+        {
+            return;
+        }
+
+        std::array<char, 64> message;
+        std::array<char, 64> field;
+        auto message_size =
+            snprintf(message.data(), message.size(),
+                     "MESSAGE=lg2 dropped %" PRIu64 " messages", count);
+        auto field_size = snprintf(field.data(), field.size(),
+                                   "LG2_DROPPED=%" PRIu64, count);
+        std::string_view priority = "PRIORITY=4";
+
+        std::array<iovec, 3> iov{{
+            {message.data(), static_cast<size_t>(message_size)},
+            {field.data(), static_cast<size_t>(field_size)},
+            {const_cast<char*>(priority.data()), priority.size()},
+        }};
+        sd_journal_sendv(iov.data(), iov.size());
+    }
+
+    record_queue queue;
+    overflow_policy policy;
+
+    // Records dropped by the overflow policy since the last report.
+    std::atomic<uint64_t> dropped{0};
+
+    // Set by the thread when it is about to wait for wakeups to change.
+    std::atomic<bool> idle{false};
+    std::atomic<uint32_t> wakeups{0};
+    std::atomic<bool> stopping{false};
+
+    std::thread thread;
+};
+
+/** The sink, if it is enabled.
+ *
+ *  Once created it is never destroyed, so that log calls on other threads or
+ *  from static destructors can't race with it going away; after it is
+ *  stopped they just send their records directly.
+ */
+static std::atomic<async_sink*> sink{nullptr};
+
+/** Storage for the sink, so that it isn't left allocated at exit. */
+alignas(async_sink) static std::byte sink_storage[sizeof(async_sink)];
+
+bool async_send(level l, const iovec* iov, size_t count)
+{
+    auto s = sink.load(std::memory_order_acquire);
+    if (s == nullptr)
+    {
+        return false;
+    }
+
+    // Don't let the most severe messages sit in the queue where a crash
+    // could lose them.  Send everything before them so they stay in order.
+    if (l <= level::critical)
+    {
+        s->flush();
+        return false;
+    }
+
+    return s->send(iov, count);
+}
+
+/** Convert the `LG2_ASYNC` environment variable to a policy. */
+static overflow_policy string_to_policy(std::string_view s)
+{
+    if (s == "drop-oldest")
+    {
+        return overflow_policy::drop_oldest;
+    }
+    if (s == "block")
+    {
+        return overflow_policy::block;
+    }
+    return overflow_policy::count_dropped;
+}
+
+// Enable the sink when the library is loaded if `LG2_ASYNC` is set.
+[[maybe_unused]] static const bool async_loaded = []() {
+    if (const char* e = getenv("LG2_ASYNC"); e != nullptr && *e != '\0')
+    {
+        enable_async(string_to_policy(e));
+    }
+    return true;
+}();
+
+} // namespace lg2::details
+
+namespace lg2
+{
+
+void enable_async(overflow_policy policy)
+{
+    static std::once_flag once;
+    std::call_once(once, [policy]() {
+        details::sink.store(new (details::sink_storage)
+                                details::async_sink(policy),
+                            std::memory_order_release);
+
+        // Send whatever is left when the process exits.
+        std::atexit([]() {
+            if (auto s = details::sink.exchange(nullptr); s != nullptr)
+            {
+                s->stop();
+            }
+        });
+
+        // The thread doesn't exist in a forked child, so it has to send
+        // directly.
+        pthread_atfork(nullptr, nullptr, []() {
+            details::sink.store(nullptr, std::memory_order_relaxed);
+        });
+    });
+}
+
+void flush()
+{
+    if (auto s = details::sink.load(std::memory_order_acquire); s != nullptr)
+    {
+        s->flush();
+    }
+}
+
+} // namespace lg2
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <sys/uio.h>
+
+#include <phosphor-logging/lg2/level.hpp>
+
+#include <cstddef>
+
+namespace lg2::details
+{
+
+/** Send a journal record through the asynchronous sink, if it is enabled.
+ *
+ *  Records at `critical` or more severe are never queued; the queue is
+ *  flushed and they are left for the caller to send right away.
+ *
+ *  @param[in] l - The level of the record.
+ *  @param[in] iov - The journal fields.
+ *  @param[in] count - The number of fields.
+ *
+ *  @return true if the sink took the record, false if the caller needs to
+ *          send it itself.
+ */
+bool async_send(level l, const iovec* iov, size_t count);
+
+} // namespace lg2::details
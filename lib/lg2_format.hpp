@@ -0,0 +1,651 @@
+#pragma once
+
+#include <phosphor-logging/lg2/flags.hpp>
+#include <phosphor-logging/lg2/level.hpp>
+#include <phosphor-logging/lg2/message.hpp>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <charconv>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+/** Formatting of lg2 messages into journal fields.
+ *
+ *  This is shared by do_log and the trace decoder, so that a message read
+ *  back from a trace comes out exactly as it would have from the journal.
+ */
+namespace lg2::details
+{
+
+/** Growable array of trivial types which only goes to the heap once it
+ *  outgrows its inline storage, so formatting can usually avoid allocating.
+ */
+template <typename T, size_t N>
+class small_buffer
+{
+  public:
+    small_buffer() = default;
+    small_buffer(const small_buffer&) = delete;
+    small_buffer& operator=(const small_buffer&) = delete;
+
+    T* data()
+    {
+        return heap ? heap.get() : inline_data.data();
+    }
+
+    size_t size() const
+    {
+        return count;
+    }
+
+    /** Get room for at least n more items past the end, without adding
+     *  them to the size. */
+    T* reserve(size_t n)
+    {
+        if (count + n > capacity)
+        {
+            grow(count + n);
+        }
+        return data() + count;
+    }
+
+    /** Add items written into the space from reserve to the size. */
+    void commit(size_t n)
+    {
+        count += n;
+    }
+
+    void append(const T* p, size_t n)
+    {
+        std::copy_n(p, n, reserve(n));
+        commit(n);
+    }
+
+    void push_back(const T& t)
+    {
+        append(&t, 1);
+    }
+
+    /** Empty the buffer, keeping any memory it has for reuse. */
+    void clear()
+    {
+        count = 0;
+    }
+
+  private:
+    void grow(size_t needed)
+    {
+        auto c = std::max(needed, capacity * 2);
+        auto p = std::make_unique_for_overwrite<T[]>(c);
+        std::copy_n(data(), count, p.get());
+        heap = std::move(p);
+        capacity = c;
+    }
+
+    std::array<T, N> inline_data;
+    std::unique_ptr<T[]> heap;
+    size_t count = 0;
+    size_t capacity = N;
+};
+
+/** Buffer the journal fields are written into.
+ *
+ *  This is big enough for the fields of nearly every message, including long
+ *  function names, without being a burden on the stack.
+ */
+using char_buffer = small_buffer<char, 2048>;
+
+inline void append(char_buffer& b, std::string_view s)
+{
+    b.append(s.data(), s.size());
+}
+
+/** Append an integer in decimal. */
+template <std::integral T>
+inline void append_decimal(char_buffer& b, T v)
+{
+    // Enough for the digits and sign of any 64-bit integer.
+    constexpr size_t max_size = 20;
+
+    auto p = b.reserve(max_size);
+    auto [end, ec] = std::to_chars(p, p + max_size, v);
+    b.commit(end - p);
+}
+
+/** Hex digit pairs for every byte, so hex is written a byte at a time. */
+inline constexpr auto hex_pairs = []() {
+    constexpr std::string_view digits = "0123456789abcdef";
+    std::array<char, 512> pairs{};
+    for (size_t i = 0; i < 256; ++i)
+    {
+        pairs[2 * i] = digits[i >> 4];
+        pairs[2 * i + 1] = digits[i & 0xf];
+    }
+    return pairs;
+}();
+
+/** Binary digits for every nibble, so binary is written 4 bits at a time. */
+inline constexpr auto bin_nibbles = []() {
+    std::array<char, 64> nibbles{};
+    for (size_t i = 0; i < 16; ++i)
+    {
+        for (size_t bit = 0; bit < 4; ++bit)
+        {
+            nibbles[4 * i + bit] = (i & (8 >> bit)) ? '1' : '0';
+        }
+    }
+    return nibbles;
+}();
+
+/** Get the width in bits from the field-length format flag, or 0 if there
+ *  isn't one. */
+inline size_t field_bits(uint64_t f)
+{
+    switch (f & (field8 | field16 | field32 | field64).value)
+    {
+        case field8.value:
+            return 8;
+        case field16.value:
+            return 16;
+        case field32.value:
+            return 32;
+        case field64.value:
+            return 64;
+        default:
+            return 0;
+    }
+}
+
+/** Append unsigned as "0x" and hex digits, zero-padded to at least the
+ *  width of the field flag. */
+inline void append_hex(char_buffer& b, uint64_t f, uint64_t v)
+{
+    size_t digits = std::max<size_t>((std::bit_width(v) + 3) / 4, 1);
+    digits = std::max(digits, field_bits(f) / 4);
+
+    // Write from the end, a byte at a time, then the odd digit if any.
+    auto p = b.reserve(digits + 2);
+    auto end = p + digits + 2;
+    auto d = end;
+    for (size_t i = 0; i < digits / 2; ++i, v >>= 8)
+    {
+        d -= 2;
+        std::copy_n(&hex_pairs[2 * (v & 0xff)], 2, d);
+    }
+    if (digits % 2)
+    {
+        *--d = hex_pairs[2 * (v & 0xf) + 1];
+    }
+    p[0] = '0';
+    p[1] = 'x';
+    b.commit(end - p);
+}
+
+/** Append unsigned as "0b" and the bits of the field, or of the whole value
+ *  if there is no field-length format flag. */
+inline void append_bin(char_buffer& b, uint64_t f, uint64_t v)
+{
+    auto bits = field_bits(f);
+    if (bits == 0)
+    {
+        bits = 64;
+    }
+
+    auto p = b.reserve(bits + 2);
+    p[0] = '0';
+    p[1] = 'b';
+    for (size_t i = 0; i < bits; i += 4)
+    {
+        std::copy_n(&bin_nibbles[4 * ((v >> (bits - i - 4)) & 0xf)], 4,
+                    p + 2 + i);
+    }
+    b.commit(bits + 2);
+}
+
+/** Append unsigned using format flags. */
+inline void append_value(char_buffer& b, uint64_t f, uint64_t v)
+{
+    switch (f & (hex | bin | dec).value)
+    {
+        case bin.value:
+        {
+            append_bin(b, f, v);
+            break;
+        }
+
+        case hex.value:
+        {
+            append_hex(b, f, v);
+            break;
+        }
+
+        case dec.value:
+        default:
+        {
+            append_decimal(b, v);
+            break;
+        }
+    }
+}
+
+/** Append signed using format flags. */
+inline void append_value(char_buffer& b, uint64_t f, int64_t v)
+{
+    // If hex or bin was requested just use the unsigned formatting
+    // rules. (What should a negative binary number look like otherwise?)
+    if (f & (hex | bin).value)
+    {
+        return append_value(b, f, static_cast<uint64_t>(v));
+    }
+    append_decimal(b, v);
+}
+
+/** Append float using format flags. */
+inline void append_value(char_buffer& b, uint64_t, double v)
+{
+    // No format flags supported for floats; match std::to_string, which is
+    // "%f".  That is at most 309 integer digits, a sign, a point and 6
+    // decimals.
+    constexpr size_t max_size = 320;
+
+    auto p = b.reserve(max_size);
+    auto [end, ec] =
+        std::to_chars(p, p + max_size, v, std::chars_format::fixed, 6);
+    b.commit(end - p);
+}
+
+/** Where a field lives in the buffer. */
+struct field_pos
+{
+    size_t start;
+    size_t end;
+};
+
+/** Fields which are written for every message, before any of the caller's.
+ */
+inline constexpr size_t static_fields = 5;
+
+/** Number of fields which fit before do_log goes to the heap. */
+inline constexpr size_t inline_fields = 32;
+
+using field_buffer = small_buffer<field_pos, inline_fields>;
+
+/** Add a field made up of a key, like "CODE_FILE=", and a string value. */
+inline void add_field(char_buffer& b, field_buffer& fields, const char* key,
+                      std::string_view value)
+{
+    auto start = b.size();
+    append(b, key);
+    append(b, value);
+    fields.push_back({start, b.size()});
+}
+
+/** Add a field made up of a key and a decimal value. */
+inline void add_field(char_buffer& b, field_buffer& fields, const char* key,
+                      uint64_t value)
+{
+    auto start = b.size();
+    append(b, key);
+    append_decimal(b, value);
+    fields.push_back({start, b.size()});
+}
+
+/** Append the value of the first unused caller's field with a header.
+ *
+ *  The caller's fields are those from 'first' on.
+ *
+ *  @return true if there was such a field.
+ */
+inline bool append_field_value(char_buffer& b, field_buffer& fields,
+                               size_t first,
+                               small_buffer<bool, inline_fields>& used,
+                               std::string_view header)
+{
+    for (size_t i = first; i < fields.size(); ++i)
+    {
+        const auto& [start, end] = fields.data()[i];
+        std::string_view field{b.data() + start, end - start};
+        if (!used.data()[i] && field.size() > header.size() &&
+            field.starts_with(header) && field[header.size()] == '=')
+        {
+            // Reserve first so the buffer can't move out from under the
+            // value while it is being copied.
+            auto value_start = start + header.size() + 1;
+            auto value_size = end - value_start;
+            b.reserve(value_size);
+            append(b, {b.data() + value_start, value_size});
+
+            used.data()[i] = true;
+            return true;
+        }
+    }
+    return false;
+}
+
+/** The journal fields of a message.
+ *
+ *  The fields are written one after another into a single buffer, and since
+ *  it may move as it grows their positions are only turned into pointers
+ *  once everything has been written.
+ */
+class journal_fields
+{
+  public:
+    /** Start without any fields. */
+    journal_fields() = default;
+
+    /** Start with the fields every message has.
+     *
+     *  @param[in] l - The level of the message.
+     *  @param[in] file - The source file of the log call.
+     *  @param[in] line - The line of the log call.
+     *  @param[in] function - The function making the log call.
+     *  @param[in] format - The message before {HEADER} replacement.
+     */
+    journal_fields(level l, std::string_view file, uint64_t line,
+                   std::string_view function, std::string_view format)
+    {
+        add_static(l, file, line, function, format);
+    }
+
+    journal_fields(const journal_fields&) = delete;
+    journal_fields& operator=(const journal_fields&) = delete;
+
+    /** Add the fields every message has, which must come before any of the
+     *  caller's.  A caller with these already formatted can leave them out.
+     *
+     *  @param[in] l - The level of the message.
+     *  @param[in] file - The source file of the log call.
+     *  @param[in] line - The line of the log call.
+     *  @param[in] function - The function making the log call.
+     *  @param[in] format - The message before {HEADER} replacement.
+     */
+    void add_static(level l, std::string_view file, uint64_t line,
+                    std::string_view function, std::string_view format)
+    {
+        add_field(buffer, fields, "LOG2_FMTMSG=", format);
+        add_field(buffer, fields, "PRIORITY=", static_cast<uint64_t>(l));
+        add_field(buffer, fields, "CODE_FILE=", file);
+        add_field(buffer, fields, "CODE_LINE=", line);
+        add_field(buffer, fields, "CODE_FUNC=", function);
+        first = static_fields;
+    }
+
+    /** Add one of the caller's fields.
+     *
+     *  @param[in] header - The field's name.
+     *  @param[in] f - The format flags of the value.
+     *  @param[in] v - The value.
+     */
+    template <typename V>
+    void add(std::string_view header, uint64_t f, V v)
+    {
+        auto start = buffer.size();
+        append(buffer, header);
+        buffer.push_back('=');
+        if constexpr (std::is_same_v<V, std::string_view>)
+        {
+            append(buffer, v);
+        }
+        else
+        {
+            append_value(buffer, f, v);
+        }
+        fields.push_back({start, buffer.size()});
+    }
+
+    /** Add the MESSAGE field, made by replacing each {HEADER} with the
+     *  value of the first field with that header which hasn't already been
+     *  used.  Values are not themselves searched for {HEADER}s.
+     */
+    void finish(const message_str& m)
+    {
+        small_buffer<bool, inline_fields> used;
+        for (size_t i = 0; i < fields.size(); ++i)
+        {
+            used.push_back(false);
+        }
+
+        // The message is at most its format plus the caller's fields, so make
+        // room for that up front rather than growing the buffer piece by
+        // piece.
+        auto message_start = buffer.size();
+        auto values_start = (fields.size() > first)
+                                ? fields.data()[first].start
+                                : message_start;
+        buffer.reserve(sizeof("MESSAGE=") + m.value.size() + message_start -
+                       values_start);
+        append(buffer, "MESSAGE=");
+        text_start = buffer.size();
+
+        if (m.parsed)
+        {
+            // The placeholders were found at compile time, so just fill
+            // them in.
+            size_t pos = 0;
+            for (size_t i = 0; i < m.count; ++i)
+            {
+                const auto& [start, size] = m.placeholders[i];
+                auto placeholder = m.value.substr(start, size);
+
+                append(buffer, m.value.substr(pos, start - pos));
+                if (!append_field_value(buffer, fields, first, used,
+                                        placeholder.substr(1, size - 2)))
+                {
+                    append(buffer, placeholder);
+                }
+                pos = start + size;
+            }
+            append(buffer, m.value.substr(pos));
+        }
+        else
+        {
+            for (auto rest = m.value; !rest.empty();)
+            {
+                auto open = rest.find('{');
+                auto close = rest.find('}', open);
+                if (close == std::string_view::npos)
+                {
+                    append(buffer, rest);
+                    break;
+                }
+
+                append(buffer, rest.substr(0, open));
+                if (append_field_value(buffer, fields, first, used,
+                                       rest.substr(open + 1, close - open - 1)))
+                {
+                    rest.remove_prefix(close + 1);
+                }
+                else
+                {
+                    // Not a header we have; keep the brace and look again
+                    // after it.
+                    buffer.push_back('{');
+                    rest.remove_prefix(open + 1);
+                }
+            }
+        }
+        fields.push_back({message_start, buffer.size()});
+    }
+
+    /** Get the number of fields. */
+    size_t size() const
+    {
+        return fields.size();
+    }
+
+    /** Get a field, as "KEY=value". */
+    std::string_view operator[](size_t i)
+    {
+        const auto& [start, end] = fields.data()[i];
+        return {buffer.data() + start, end - start};
+    }
+
+    /** Get the message text, once finish has been called. */
+    std::string_view message()
+    {
+        return {buffer.data() + text_start, buffer.size() - text_start};
+    }
+
+  private:
+    char_buffer buffer;
+    field_buffer fields;
+    // Index of the first of the caller's fields.
+    size_t first = 0;
+    size_t text_start = 0;
+};
+
+/** An `LG2_FORMAT` format string, compiled once into a list of tokens so
+ *  that rendering a message doesn't have to parse it again.
+ *
+ *  The format is text with these replacements:
+ *  - %f : the function making the log call.
+ *  - %F : the source file of the log call.
+ *  - %l : the level, as a syslog priority.
+ *  - %L : the line of the log call.
+ *  - %m : the message text.
+ *  - %% : a '%'.
+ *  Any other '%' is left as it is.
+ */
+class output_format
+{
+  public:
+    explicit output_format(std::string_view format)
+    {
+        for (size_t i = 0; i < format.size(); ++i)
+        {
+            if (format[i] != '%')
+            {
+                add_text(format.substr(i, 1));
+                continue;
+            }
+
+            if (++i == format.size())
+            {
+                add_text("%");
+                break;
+            }
+
+            switch (format[i])
+            {
+                case '%':
+                    add_text("%");
+                    break;
+
+                case 'f':
+                    tokens.push_back({part::function, 0, 0});
+                    break;
+
+                case 'F':
+                    tokens.push_back({part::file, 0, 0});
+                    break;
+
+                case 'l':
+                    tokens.push_back({part::level, 0, 0});
+                    break;
+
+                case 'L':
+                    tokens.push_back({part::line, 0, 0});
+                    break;
+
+                case 'm':
+                    tokens.push_back({part::message, 0, 0});
+                    break;
+
+                default:
+                    add_text(format.substr(i - 1, 2));
+                    break;
+            }
+        }
+    }
+
+    /** Append a message to a buffer.
+     *
+     *  @param[in] b - The buffer to append to.
+     *  @param[in] l - The level of the message.
+     *  @param[in] file - The source file of the log call.
+     *  @param[in] line - The line of the log call.
+     *  @param[in] function - The function making the log call.
+     *  @param[in] m - The message text.
+     */
+    void render(char_buffer& b, level l, std::string_view file, uint64_t line,
+                std::string_view function, std::string_view m) const
+    {
+        for (const auto& t : tokens)
+        {
+            switch (t.p)
+            {
+                case part::text:
+                    append(b, std::string_view{text}.substr(t.start, t.size));
+                    break;
+
+                case part::function:
+                    append(b, function);
+                    break;
+
+                case part::file:
+                    append(b, file);
+                    break;
+
+                case part::level:
+                    append_decimal(b, static_cast<uint64_t>(l));
+                    break;
+
+                case part::line:
+                    append_decimal(b, line);
+                    break;
+
+                case part::message:
+                    append(b, m);
+                    break;
+            }
+        }
+    }
+
+  private:
+    enum class part : uint8_t
+    {
+        text,
+        function,
+        file,
+        level,
+        line,
+        message,
+    };
+
+    struct token
+    {
+        part p;
+        // Location of the characters in 'text', for part::text.
+        uint32_t start;
+        uint32_t size;
+    };
+
+    /** Add literal text, merging it with any text just before it. */
+    void add_text(std::string_view s)
+    {
+        if (!tokens.empty() && tokens.back().p == part::text)
+        {
+            tokens.back().size += s.size();
+        }
+        else
+        {
+            tokens.push_back({part::text, static_cast<uint32_t>(text.size()),
+                              static_cast<uint32_t>(s.size())});
+        }
+        text.append(s);
+    }
+
+    std::string text;
+    std::vector<token> tokens;
+};
+
+} // namespace lg2::details
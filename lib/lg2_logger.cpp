@@ -1,307 +1,267 @@
 #define SD_JOURNAL_SUPPRESS_LOCATION
 
+#include "lg2_async.hpp"
+#include "lg2_format.hpp"
+#include "lg2_site.hpp"
+#include "lg2_trace.hpp"
+
 #include <systemd/sd-journal.h>
 #include <unistd.h>
 
 #include <phosphor-logging/lg2.hpp>
 
-#include <algorithm>
-#include <bitset>
+#include <cerrno>
 #include <cstdarg>
 #include <cstdio>
-#include <iostream>
-#include <mutex>
+#include <cstdlib>
+#include <fstream>
+#include <optional>
 #include <source_location>
-#include <sstream>
-#include <vector>
+#include <string_view>
 
 namespace lg2::details
 {
-/** Convert unsigned to string using format flags. */
-static std::string value_to_string(uint64_t f, uint64_t v)
+
+/** No-op output of a message. */
+static void noop_extra_output(level, const std::source_location&,
+                              std::string_view)
+{}
+
+/** Write all of a buffer to a file descriptor. */
+static void write_all(int fd, const char* data, size_t size)
 {
-    switch (f & (hex | bin | dec).value)
+    while (size > 0)
     {
-        // For binary, use bitset<>::to_string.
-        // Treat values without a field-length format flag as 64 bit.
-        case bin.value:
+        auto n = write(fd, data, size);
+        if (n < 0)
         {
-            switch (f & (field8 | field16 | field32 | field64).value)
+            if (errno == EINTR)
             {
-                case field8.value:
-                {
-                    return "0b" + std::bitset<8>(v).to_string();
-                }
-                case field16.value:
-                {
-                    return "0b" + std::bitset<16>(v).to_string();
-                }
-                case field32.value:
-                {
-                    return "0b" + std::bitset<32>(v).to_string();
-                }
-                case field64.value:
-                default:
-                {
-                    return "0b" + std::bitset<64>(v).to_string();
-                }
+                continue;
             }
+            return;
         }
-
-        // For hex, use the appropriate sprintf.
-        case hex.value:
-        {
-            char value[19];
-            const char* format = nullptr;
-
-            switch (f & (field8 | field16 | field32 | field64).value)
-            {
-                case field8.value:
-                {
-                    format = "0x%02" PRIx64;
-                    break;
-                }
-
-                case field16.value:
-                {
-                    format = "0x%04" PRIx64;
-                    break;
-                }
-
-                case field32.value:
-                {
-                    format = "0x%08" PRIx64;
-                    break;
-                }
-
-                case field64.value:
-                {
-                    format = "0x%016" PRIx64;
-                    break;
-                }
-
-                default:
-                {
-                    format = "0x%" PRIx64;
-                    break;
-                }
-            }
-
-            snprintf(value, sizeof(value), format, v);
-            return value;
-        }
-
-        // For dec, use the simple to_string.
-        case dec.value:
-        default:
-        {
-            return std::to_string(v);
-        }
+        data += n;
+        size -= n;
     }
 }
 
-/** Convert signed to string using format flags. */
-static std::string value_to_string(uint64_t f, int64_t v)
-{
-    // If hex or bin was requested just use the unsigned formatting
-    // rules. (What should a negative binary number look like otherwise?)
-    if (f & (hex | bin).value)
-    {
-        return value_to_string(f, static_cast<uint64_t>(v));
-    }
-    return std::to_string(v);
-}
-
-/** Convert float to string using format flags. */
-static std::string value_to_string(uint64_t, double v)
-{
-    // No format flags supported for floats.
-    return std::to_string(v);
-}
-
-// Positions of various strings in an iovec.
-static constexpr size_t pos_msg = 0;
-static constexpr size_t pos_fmtmsg = 1;
-static constexpr size_t pos_prio = 2;
-static constexpr size_t pos_file = 3;
-static constexpr size_t pos_line = 4;
-static constexpr size_t pos_func = 5;
-static constexpr size_t static_locs = pos_func + 1;
-
-/** No-op output of a message. */
-static void noop_extra_output(level, const std::source_location&,
-                              const std::string&)
-{}
-
-/** std::cerr output of a message. */
+/** stderr output of a message. */
 static void cerr_extra_output(level l, const std::source_location& s,
-                              const std::string& m)
+                              std::string_view m)
 {
-    static const char* const defaultFormat = []() {
+    static const output_format format = []() {
         const char* f = getenv("LG2_FORMAT");
         if (nullptr == f)
         {
             f = "<%l> %m";
         }
-        return f;
+        return output_format(f);
     }();
 
-    const char* format = defaultFormat;
-
-    std::stringstream stream;
+    thread_local char_buffer buffer;
+    buffer.clear();
+    format.render(buffer, l, s.file_name(), s.line(), s.function_name(), m);
+    buffer.push_back('\n');
 
-    while (*format)
-    {
-        if (*format != '%')
-        {
-            stream << *format;
-            ++format;
-            continue;
-        }
+    // Each line goes out in a single write, so lines from different threads
+    // don't clobber each other without needing a lock.
+    write_all(STDERR_FILENO, buffer.data(), buffer.size());
+}
 
-        ++format;
-        switch (*format)
-        {
-            case '%':
-            case '\0':
-                stream << '%';
-                break;
+// Use the cerr output method if we are on a TTY or if explicitly set via
+// environment variable.
+static auto extra_output_method = (isatty(fileno(stderr)) ||
+                                   nullptr != getenv("LG2_FORCE_STDERR"))
+                                      ? cerr_extra_output
+                                      : noop_extra_output;
 
-            case 'f':
-                stream << s.function_name();
-                break;
+std::atomic<int> threshold{LOG_DEBUG};
 
-            case 'F':
-                stream << s.file_name();
-                break;
+/** File the threshold is read from when `LG2_LEVEL` isn't set. */
+static constexpr auto threshold_file = "/etc/phosphor-logging/lg2.conf";
 
-            case 'l':
-                stream << static_cast<uint64_t>(l);
-                break;
+/** Convert a level name, like "info", or syslog priority, like "6". */
+static std::optional<level> string_to_level(std::string_view s)
+{
+    static constexpr std::pair<std::string_view, level> names[] = {
+        {"emergency", level::emergency}, {"emerg", level::emergency},
+        {"alert", level::alert},         {"critical", level::critical},
+        {"crit", level::critical},       {"error", level::error},
+        {"err", level::error},           {"warning", level::warning},
+        {"warn", level::warning},        {"notice", level::notice},
+        {"info", level::info},           {"debug", level::debug},
+    };
+
+    for (const auto& [name, l] : names)
+    {
+        if (s == name)
+        {
+            return l;
+        }
+    }
 
-            case 'L':
-                stream << s.line();
-                break;
+    if (s.size() == 1 && s[0] >= '0' + LOG_EMERG && s[0] <= '0' + LOG_DEBUG)
+    {
+        return static_cast<level>(s[0] - '0');
+    }
 
-            case 'm':
-                stream << m;
-                break;
+    return std::nullopt;
+}
 
-            default:
-                stream << '%' << *format;
-                break;
-        }
+/** Find the configured threshold.
+ *
+ *  `LG2_LEVEL` from the environment wins, then a `LG2_LEVEL=` line in the
+ *  config file, which uses the systemd EnvironmentFile syntax so the same
+ *  file can be handed to services.
+ */
+static std::optional<level> configured_threshold()
+{
+    if (const char* e = getenv("LG2_LEVEL"); e != nullptr)
+    {
+        return string_to_level(e);
+    }
 
-        if (*format != '\0')
+    std::ifstream file{threshold_file};
+    std::string line;
+    while (std::getline(file, line))
+    {
+        constexpr std::string_view key = "LG2_LEVEL=";
+        if (line.starts_with(key))
         {
-            ++format;
+            return string_to_level(std::string_view{line}.substr(key.size()));
         }
     }
 
-    static std::mutex mutex;
-
-    // Prevent multiple threads from clobbering the stderr lines of each other
-    std::scoped_lock lock(mutex);
-
-    // Ensure this line makes it out before releasing mutex for next line
-    std::cerr << stream.str() << std::endl;
+    return std::nullopt;
 }
 
-// Use the cerr output method if we are on a TTY or if explicitly set via
-// environment variable.
-static auto extra_output_method = (isatty(fileno(stderr)) ||
-                                   nullptr != getenv("LG2_FORCE_STDERR"))
-                                      ? cerr_extra_output
-                                      : noop_extra_output;
+// Read the threshold when the library is loaded.
+[[maybe_unused]] static const bool threshold_loaded = []() {
+    if (auto l = configured_threshold(); l)
+    {
+        threshold.store(static_cast<int>(*l), std::memory_order_relaxed);
+    }
+    return true;
+}();
 
 // Do_log implementation.
-void do_log(level l, const std::source_location& s, const char* m, ...)
+void do_log(level l, const std::source_location& s, const message_str* m,
+            ...)
 {
-    using namespace std::string_literals;
+    std::va_list args;
+    va_start(args, m);
 
-    std::vector<std::string> strings{static_locs};
+    // Traced messages are formatted when the trace is read, instead of
+    // going to the journal, unless they are too severe to risk missing.
+    if (trace::write(l, s, *m, args) && l > level::critical)
+    {
+        va_end(args);
+        return;
+    }
 
-    std::string message{m};
+    // The fields which are the same for every message from a call site are
+    // formatted once and reused, when the message is constant so the site
+    // can be identified.
+    const site_fields* site = m->constant ? find_site_fields(l, s, *m)
+                                          : nullptr;
 
-    // Assign all the static fields.
-    strings[pos_fmtmsg] = "LOG2_FMTMSG="s + m;
-    strings[pos_prio] = "PRIORITY="s + std::to_string(static_cast<uint64_t>(l));
-    strings[pos_file] = "CODE_FILE="s + s.file_name();
-    strings[pos_line] = "CODE_LINE="s + std::to_string(s.line());
-    strings[pos_func] = "CODE_FUNC="s + s.function_name();
+    journal_fields fields;
+    if (site == nullptr)
+    {
+        fields.add_static(l, s.file_name(), s.line(), s.function_name(),
+                          m->value);
+    }
 
     // Handle all the va_list args.
-    std::va_list args;
-    va_start(args, m);
     while (true)
     {
         // Get the header out.
-        auto h_ptr = va_arg(args, const char*);
-        if (h_ptr == nullptr)
+        auto h = va_arg(args, const char*);
+        if (h == nullptr)
         {
             break;
         }
-        std::string h{h_ptr};
 
         // Get the format flag.
         auto f = va_arg(args, uint64_t);
 
         // Handle the value depending on which type format flag it has.
-        std::string value = {};
         switch (f & (signed_val | unsigned_val | str | floating).value)
         {
             case signed_val.value:
             {
-                auto v = va_arg(args, int64_t);
-                value = value_to_string(f, v);
+                fields.add(h, f, va_arg(args, int64_t));
                 break;
             }
 
             case unsigned_val.value:
             {
-                auto v = va_arg(args, uint64_t);
-                value = value_to_string(f, v);
+                fields.add(h, f, va_arg(args, uint64_t));
                 break;
             }
 
             case str.value:
             {
-                value = va_arg(args, const char*);
+                fields.add(h, f, std::string_view{va_arg(args, const char*)});
                 break;
             }
 
             case floating.value:
             {
-                auto v = va_arg(args, double);
-                value = value_to_string(f, v);
+                fields.add(h, f, va_arg(args, double));
                 break;
             }
         }
+    }
+    va_end(args);
 
-        // Create the field for this value.
-        strings.emplace_back(h + '=' + value);
+    fields.finish(*m);
 
-        // Check for {HEADER} in the message and replace with value.
-        auto h_brace = '{' + h + '}';
-        if (auto start = message.find(h_brace); start != std::string::npos)
+    // Now that the buffer won't move, point the iovecs at the fields.
+    small_buffer<iovec, inline_fields> iov;
+    if (site != nullptr)
+    {
+        for (auto field : site->fields)
         {
-            message.replace(start, h_brace.size(), value);
+            iov.push_back({const_cast<char*>(field.data()), field.size()});
         }
     }
-    va_end(args);
-
-    // Add the final message into the strings array.
-    strings[pos_msg] = "MESSAGE="s + message.data();
-
-    // Trasform strings -> iovec.
-    std::vector<iovec> iov{};
-    std::ranges::transform(strings, std::back_inserter(iov), [](auto& s) {
-        return iovec{s.data(), s.length()};
-    });
+    for (size_t i = 0; i < fields.size(); ++i)
+    {
+        auto field = fields[i];
+        iov.push_back({const_cast<char*>(field.data()), field.size()});
+    }
 
     // Output the iovec.
-    sd_journal_sendv(iov.data(), strings.size());
-    extra_output_method(l, s, message);
+    if (!async_send(l, iov.data(), iov.size()))
+    {
+        sd_journal_sendv(iov.data(), iov.size());
+    }
+    extra_output_method(l, s, fields.message());
+}
+
+void log_suppressed(level l, const std::source_location& s, uint64_t count)
+{
+    log_conversion::start(l, s,
+                          "Suppressed {LG2_SUPPRESSED} messages from here",
+                          header_str{"LG2_SUPPRESSED"}, count);
 }
 
 } // namespace lg2::details
+
+namespace lg2
+{
+
+void set_threshold(level l)
+{
+    details::threshold.store(static_cast<int>(l), std::memory_order_relaxed);
+}
+
+level get_threshold()
+{
+    return static_cast<level>(
+        details::threshold.load(std::memory_order_relaxed));
+}
+
+} // namespace lg2
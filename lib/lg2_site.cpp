@@ -0,0 +1,58 @@
+#include "lg2_site.hpp"
+
+#include <array>
+#include <atomic>
+
+namespace lg2::details
+{
+
+/** Most call sites whose fields are cached; must be a power of two. */
+static constexpr size_t cache_size = 1024;
+
+/** Slots searched for a call site before giving up on caching it. */
+static constexpr size_t max_probes = 16;
+
+/** Open-addressed table of call sites.
+ *
+ *  Entries are only ever added, never replaced or freed, so finding one is a
+ *  few loads without any locking.
+ */
+static std::array<std::atomic<const site_fields*>, cache_size> cache{};
+
+const site_fields* find_site_fields(level l, const std::source_location& s,
+                                    const message_str& m)
+{
+    site_key key{l, s, m};
+    auto h = site_key_hash{}(key);
+
+    const site_fields* created = nullptr;
+    for (size_t i = 0; i < max_probes; ++i)
+    {
+        auto& slot = cache[(h + i) & (cache_size - 1)];
+        auto p = slot.load(std::memory_order_acquire);
+        if (p == nullptr)
+        {
+            if (created == nullptr)
+            {
+                created = new site_fields(key);
+            }
+            if (slot.compare_exchange_strong(p, created,
+                                             std::memory_order_acq_rel))
+            {
+                return created;
+            }
+            // Another thread took the slot first, perhaps for this site.
+        }
+
+        if (p->key == key)
+        {
+            delete created;
+            return p;
+        }
+    }
+
+    delete created;
+    return nullptr;
+}
+
+} // namespace lg2::details
@@ -0,0 +1,103 @@
+#pragma once
+
+#include "lg2_format.hpp"
+
+#include <phosphor-logging/lg2/level.hpp>
+#include <phosphor-logging/lg2/message.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <source_location>
+#include <string>
+#include <string_view>
+
+namespace lg2::details
+{
+
+/** Identity of a call site.
+ *
+ *  Messages, file names and function names are string literals, so their
+ *  addresses are enough to tell call sites apart without comparing the
+ *  strings.  This is only valid for constant messages.
+ */
+struct site_key
+{
+    const char* message;
+    const char* file;
+    const char* function;
+    uint32_t line;
+    uint32_t column;
+    level l;
+
+    site_key(level l, const std::source_location& s, const message_str& m) :
+        message(m.data()), file(s.file_name()), function(s.function_name()),
+        line(s.line()), column(s.column()), l(l)
+    {}
+
+    bool operator==(const site_key&) const = default;
+};
+
+struct site_key_hash
+{
+    size_t operator()(const site_key& k) const
+    {
+        uint64_t h = reinterpret_cast<uintptr_t>(k.message);
+        h = h * 31 + reinterpret_cast<uintptr_t>(k.file);
+        h = h * 31 + reinterpret_cast<uintptr_t>(k.function);
+        h = h * 31 + k.line;
+        h = h * 31 + k.column;
+        h = h * 31 + static_cast<uint64_t>(k.l);
+
+        // Mix the high bits down, since tables index by the low ones.
+        h *= 0x9e3779b97f4a7c15;
+        return h ^ (h >> 32);
+    }
+};
+
+/** The journal fields which are the same for every message from a call
+ *  site: LOG2_FMTMSG, PRIORITY, CODE_FILE, CODE_LINE and CODE_FUNC. */
+struct site_fields
+{
+    explicit site_fields(const site_key& key) : key(key)
+    {
+        journal_fields f(key.l, key.file, key.line, key.function,
+                         key.message);
+        std::array<size_t, static_fields> ends;
+        for (size_t i = 0; i < static_fields; ++i)
+        {
+            data.append(f[i]);
+            ends[i] = data.size();
+        }
+
+        size_t start = 0;
+        for (size_t i = 0; i < static_fields; ++i)
+        {
+            fields[i] = std::string_view{data}.substr(start, ends[i] - start);
+            start = ends[i];
+        }
+    }
+
+    site_fields(const site_fields&) = delete;
+    site_fields& operator=(const site_fields&) = delete;
+
+    site_key key;
+    std::string data;
+    std::array<std::string_view, static_fields> fields;
+};
+
+/** Find the static fields of a call site, formatting them the first time
+ *  it logs.
+ *
+ *  The fields are kept for the life of the process.
+ *
+ *  @param[in] l - The level of the message.
+ *  @param[in] s - The source location of the log call.
+ *  @param[in] m - The message, which must be constant.
+ *
+ *  @return the fields, or nullptr if too many call sites are cached already.
+ */
+const site_fields* find_site_fields(level l, const std::source_location& s,
+                                    const message_str& m);
+
+} // namespace lg2::details
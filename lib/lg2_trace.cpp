@@ -0,0 +1,339 @@
+#include "lg2_trace.hpp"
+
+#include "lg2_format.hpp"
+#include "lg2_site.hpp"
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <phosphor-logging/lg2/flags.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace lg2::details::trace
+{
+
+/** Bytes set aside for the call site table. */
+static constexpr size_t sites_size = 64 * 1024;
+
+/** Default bytes for the ring of records. */
+static constexpr size_t default_ring_size = 1024 * 1024;
+
+/** Append a uint32_t length and the characters of a string. */
+static void append_string(char_buffer& b, std::string_view s)
+{
+    uint32_t size = s.size();
+    b.append(reinterpret_cast<const char*>(&size), sizeof(size));
+    append(b, s);
+}
+
+/** A trace file mapped into memory. */
+class trace_file
+{
+  public:
+    trace_file(char* base, size_t ring_size) :
+        header(reinterpret_cast<file_header*>(base)),
+        sites(base + sizeof(file_header)),
+        ring(sites + sites_size)
+    {
+        *header = {};
+        header->magic = magic;
+        header->version = version;
+        header->pid = getpid();
+        std::string_view(program_invocation_short_name)
+            .copy(header->comm.data(), header->comm.size());
+        header->sites_offset = sites - base;
+        header->sites_size = sites_size;
+        header->ring_offset = ring - base;
+        header->ring_size = ring_size;
+    }
+
+    trace_file(const trace_file&) = delete;
+    trace_file& operator=(const trace_file&) = delete;
+
+    bool write(level l, const std::source_location& s, const message_str& m,
+               std::va_list args)
+    {
+        // Encode the record before taking the lock.
+        char_buffer record;
+        small_buffer<const char*, inline_fields> headers;
+
+        record.reserve(sizeof(record_header));
+        record.commit(sizeof(record_header));
+
+        while (true)
+        {
+            auto h = va_arg(args, const char*);
+            if (h == nullptr)
+            {
+                break;
+            }
+            headers.push_back(h);
+
+            auto f = va_arg(args, uint64_t);
+            uint16_t flags = f;
+            record.append(reinterpret_cast<const char*>(&flags),
+                          sizeof(flags));
+
+            switch (f & (signed_val | unsigned_val | str | floating).value)
+            {
+                case signed_val.value:
+                {
+                    append_number(record, va_arg(args, int64_t));
+                    break;
+                }
+
+                case unsigned_val.value:
+                {
+                    append_number(record, va_arg(args, uint64_t));
+                    break;
+                }
+
+                case str.value:
+                {
+                    append_string(record, va_arg(args, const char*));
+                    break;
+                }
+
+                case floating.value:
+                {
+                    append_number(record, va_arg(args, double));
+                    break;
+                }
+            }
+        }
+
+        // Pad to keep every record aligned.
+        auto padding = -record.size() % record_align;
+        std::fill_n(record.reserve(padding), padding, '\0');
+        record.commit(padding);
+
+        if (record.size() > header->ring_size / 2)
+        {
+            return false;
+        }
+
+        timespec now{};
+        clock_gettime(CLOCK_REALTIME, &now);
+
+        std::scoped_lock lock(mutex);
+
+        auto site = find_site(l, s, m, headers);
+        if (!site)
+        {
+            return false;
+        }
+
+        record_header rh{static_cast<uint32_t>(record.size()), *site,
+                         static_cast<uint64_t>(now.tv_sec) * 1000000 +
+                             static_cast<uint64_t>(now.tv_nsec) / 1000};
+        memcpy(record.data(), &rh, sizeof(rh));
+
+        append_record(record.data(), record.size());
+        return true;
+    }
+
+  private:
+    template <typename T>
+    static void append_number(char_buffer& b, T v)
+    {
+        uint32_t size = sizeof(v);
+        b.append(reinterpret_cast<const char*>(&size), sizeof(size));
+        b.append(reinterpret_cast<const char*>(&v), sizeof(v));
+    }
+
+    /** Find the offset of a call site, adding it to the table if needed.
+     *
+     *  @return the offset, or nothing if the table is full.
+     */
+    std::optional<uint32_t>
+        find_site(level l, const std::source_location& s, const message_str& m,
+                  small_buffer<const char*, inline_fields>& headers)
+    {
+        site_key key{l, s, m};
+        if (auto it = site_offsets.find(key); it != site_offsets.end())
+        {
+            return it->second;
+        }
+
+        char_buffer entry;
+        entry.reserve(sizeof(site_header));
+        entry.commit(sizeof(site_header));
+        append_string(entry, s.file_name());
+        append_string(entry, s.function_name());
+        append_string(entry, m.value);
+        for (size_t i = 0; i < headers.size(); ++i)
+        {
+            append_string(entry, headers.data()[i]);
+        }
+
+        site_header sh{static_cast<uint32_t>(entry.size()),
+                       static_cast<uint32_t>(l), s.line(),
+                       static_cast<uint32_t>(headers.size())};
+        memcpy(entry.data(), &sh, sizeof(sh));
+
+        auto offset = header->sites_used;
+        if (offset + entry.size() > header->sites_size)
+        {
+            return std::nullopt;
+        }
+
+        memcpy(sites + offset, entry.data(), entry.size());
+        std::atomic_ref(header->sites_used)
+            .store(offset + entry.size(), std::memory_order_release);
+
+        site_offsets.emplace(key, offset);
+        return offset;
+    }
+
+    /** Get the size of the record at a position, including any implicit
+     *  skip to the start of the ring. */
+    uint64_t record_size(uint64_t pos) const
+    {
+        auto offset = pos % header->ring_size;
+        auto left = header->ring_size - offset;
+        if (left < sizeof(record_header))
+        {
+            return left;
+        }
+
+        record_header rh;
+        memcpy(&rh, ring + offset, sizeof(rh));
+        return rh.size;
+    }
+
+    /** Copy a record into the ring, dropping the oldest ones to make room.
+     */
+    void append_record(const char* data, size_t size)
+    {
+        auto ring_size = header->ring_size;
+        auto head = header->head;
+        auto tail = header->tail;
+
+        auto offset = tail % ring_size;
+        auto skip = (ring_size - offset < size) ? ring_size - offset : 0;
+
+        while (tail + skip + size - head > ring_size)
+        {
+            head += record_size(head);
+        }
+
+        if (skip >= sizeof(record_header))
+        {
+            record_header rh{static_cast<uint32_t>(skip), padding_site, 0};
+            memcpy(ring + offset, &rh, sizeof(rh));
+        }
+        tail += skip;
+
+        memcpy(ring + tail % ring_size, data, size);
+        tail += size;
+
+        std::atomic_ref(header->head).store(head, std::memory_order_release);
+        std::atomic_ref(header->tail).store(tail, std::memory_order_release);
+    }
+
+    file_header* header;
+    char* sites;
+    char* ring;
+
+    std::mutex mutex;
+    std::unordered_map<site_key, uint32_t, site_key_hash> site_offsets;
+};
+
+/** The trace file, if tracing is enabled.
+ *
+ *  Like the mapping, it is never freed once created, so log calls from
+ *  other threads or static destructors can't race with it going away.
+ */
+static std::atomic<trace_file*> tracer{nullptr};
+
+bool write(level l, const std::source_location& s, const message_str& m,
+           std::va_list args)
+{
+    // Call sites are told apart by the address of their message, which is
+    // only safe for string literals.
+    auto t = tracer.load(std::memory_order_acquire);
+    if (t == nullptr || !m.constant)
+    {
+        return false;
+    }
+
+    std::va_list copy;
+    va_copy(copy, args);
+    auto written = t->write(l, s, m, copy);
+    va_end(copy);
+    return written;
+}
+
+/** Create and map the trace file in a directory. */
+static trace_file* open_trace(const std::string& dir, size_t ring_size)
+{
+    // Keep the ring a whole number of records.
+    ring_size -= ring_size % record_align;
+
+    auto path = dir + "/" + program_invocation_short_name + "." +
+                std::to_string(getpid()) + ".lg2trace";
+    int fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0640);
+    if (fd < 0)
+    {
+        return nullptr;
+    }
+
+    size_t size = sizeof(file_header) + sites_size + ring_size;
+    void* base = MAP_FAILED;
+    if (ftruncate(fd, size) == 0)
+    {
+        base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+
+    if (base == MAP_FAILED)
+    {
+        unlink(path.c_str());
+        return nullptr;
+    }
+
+    return new trace_file(static_cast<char*>(base), ring_size);
+}
+
+// Open the trace file when the library is loaded if `LG2_TRACE` is set.
+[[maybe_unused]] static const bool trace_loaded = []() {
+    const char* dir = getenv("LG2_TRACE");
+    if (dir == nullptr || *dir == '\0')
+    {
+        return false;
+    }
+
+    size_t ring_size = default_ring_size;
+    if (const char* kib = getenv("LG2_TRACE_SIZE"); kib != nullptr)
+    {
+        if (auto n = strtoull(kib, nullptr, 10); n > 0)
+        {
+            ring_size = n * 1024;
+        }
+    }
+
+    tracer.store(open_trace(dir, ring_size), std::memory_order_release);
+
+    // A forked child would be writing into its parent's file without its
+    // lock, so it goes back to the journal.
+    pthread_atfork(nullptr, nullptr, []() {
+        tracer.store(nullptr, std::memory_order_relaxed);
+    });
+
+    return true;
+}();
+
+} // namespace lg2::details::trace
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <phosphor-logging/lg2/level.hpp>
+#include <phosphor-logging/lg2/message.hpp>
+
+#include <array>
+#include <cstdarg>
+#include <cstddef>
+#include <cstdint>
+#include <source_location>
+
+/** Binary trace files which lg2 can write in place of the journal.
+ *
+ *  A trace file is a file_header, then a table of call sites, then a ring of
+ *  records.  Messages are not formatted when they are logged: a record only
+ *  holds the call site and the raw values, and lg2-trace-decode formats them
+ *  when the file is read.
+ *
+ *  Each call site is written to the table the first time it logs, as a
+ *  site_header followed by the file name, the function name, the message
+ *  and then each field's header, each as a uint32_t length and the
+ *  characters.
+ *
+ *  Each record is a record_header followed by each of the call's values,
+ *  as the uint16_t format flags, a uint32_t size and then the value: 8 bytes
+ *  of uint64_t, int64_t or double for numbers, or the characters for
+ *  strings.  None of these are aligned.
+ *
+ *  Positions in the ring count every byte ever written, and the offset of a
+ *  position is it modulo the ring size.  A record never wraps: when there
+ *  isn't room for one before the end, the rest is skipped with a padding
+ *  record, or implicitly if there isn't room for a record_header either.
+ *  The oldest records are dropped to make room for new ones.
+ */
+namespace lg2::details::trace
+{
+
+inline constexpr std::array<char, 8> magic{'L', 'G', '2', 'T',
+                                           'R', 'A', 'C', 'E'};
+inline constexpr uint32_t version = 1;
+
+struct file_header
+{
+    std::array<char, 8> magic;
+    uint32_t version;
+    uint32_t pid;
+    // The process's name, NUL padded.
+    std::array<char, 16> comm;
+    uint64_t sites_offset;
+    uint64_t sites_size;
+    // Bytes of the site table in use.
+    uint64_t sites_used;
+    uint64_t ring_offset;
+    uint64_t ring_size;
+    // Position of the oldest record.
+    uint64_t head;
+    // Position after the newest record.
+    uint64_t tail;
+};
+
+struct site_header
+{
+    // Size of the whole entry.
+    uint32_t size;
+    uint32_t level;
+    uint32_t line;
+    // Number of field headers.
+    uint32_t headers;
+};
+
+struct record_header
+{
+    // Size of the whole record, a multiple of record_align.
+    uint32_t size;
+    // Offset of the call site in the site table, or padding_site.
+    uint32_t site;
+    // Microseconds since the epoch, like the journal's timestamps.
+    uint64_t timestamp;
+};
+
+inline constexpr uint32_t padding_site = UINT32_MAX;
+inline constexpr size_t record_align = 8;
+
+/** Size of the flags and size in front of each value in a record. */
+inline constexpr size_t value_header_size = sizeof(uint16_t) +
+                                            sizeof(uint32_t);
+
+/** Write a message to the trace file, if tracing is enabled.
+ *
+ *  @param[in] l - The level of the message.
+ *  @param[in] s - The source location of the log call.
+ *  @param[in] m - The message.
+ *  @param[in] args - The { header, flags, value } arguments of do_log.
+ *
+ *  @return true if the message was written.
+ */
+bool write(level l, const std::source_location& s, const message_str& m,
+           std::va_list args);
+
+} // namespace lg2::details::trace
@@ -9,13 +9,13 @@
 #include "util.hpp"
 
 #include <systemd/sd-bus.h>
-#include <systemd/sd-journal.h>
 #include <unistd.h>
 
 #include <phosphor-logging/lg2.hpp>
 #include <sdbusplus/vtable.hpp>
 #include <xyz/openbmc_project/State/Host/server.hpp>
 
+#include <algorithm>
 #include <cassert>
 #include <chrono>
 #include <cstdio>
@@ -25,9 +25,13 @@
 #include <future>
 #include <iostream>
 #include <map>
+#include <optional>
 #include <set>
 #include <string>
 #include <string_view>
+#include <system_error>
+#include <thread>
+#include <utility>
 #include <vector>
 
 using namespace std::chrono;
@@ -68,6 +72,13 @@ int Manager::getInfoErrSize()
 uint32_t Manager::commit(uint64_t transactionId, std::string errMsg)
 {
     auto level = getLevel(errMsg);
+
+    // Unit tests expect the entry to exist when this returns.
+    if (ASYNC_COMMIT && !IS_UNIT_TEST)
+    {
+        return queueCommit(transactionId, std::move(errMsg), level);
+    }
+
     _commit(transactionId, std::move(errMsg), level);
     return entryId;
 }
@@ -75,6 +86,12 @@ uint32_t Manager::commit(uint64_t transactionId, std::string errMsg)
 uint32_t Manager::commitWithLvl(uint64_t transactionId, std::string errMsg,
                                 uint32_t errLvl)
 {
+    if (ASYNC_COMMIT && !IS_UNIT_TEST)
+    {
+        return queueCommit(transactionId, std::move(errMsg),
+                           static_cast<Entry::Level>(errLvl));
+    }
+
     _commit(transactionId, std::move(errMsg),
             static_cast<Entry::Level>(errLvl));
     return entryId;
@@ -83,120 +100,112 @@ uint32_t Manager::commitWithLvl(uint64_t transactionId, std::string errMsg,
 void Manager::_commit(uint64_t transactionId [[maybe_unused]],
                       std::string&& errMsg, Entry::Level errLvl)
 {
-    std::vector<std::string> additionalData{};
-
     // When running as a test-case, the system may have a LOT of journal
     // data and we may not have permissions to do some of the journal sync
     // operations.  Just skip over them.
+    if (IS_UNIT_TEST)
+    {
+        createEntry(errMsg, errLvl, {});
+        return;
+    }
+
+    // Flush all the pending log messages into the journal.  Extensions
+    // that sync it again while the entry is created, like the PEL journal
+    // capture, share this flush.
+    journalSync.coalesce([this, transactionId, &errMsg, errLvl]() {
+        journalSync.sync();
+
+        auto additionalData = harvestMetadata(transactionId, errMsg);
+        createEntry(errMsg, errLvl, additionalData);
+    });
+}
+
+uint32_t Manager::queueCommit(uint64_t transactionId, std::string&& errMsg,
+                              Entry::Level errLvl)
+{
+    auto id = ++entryId;
+    pendingCommits.emplace(
+        id, PendingCommit{transactionId, std::move(errMsg), errLvl});
+
+    // The journal sync service runs its callbacks in the order they were
+    // requested, so entries are still created in ID order.  Unit tests
+    // finish the commits themselves.
     if (!IS_UNIT_TEST)
     {
-        static constexpr auto transactionIdVar =
-            std::string_view{"TRANSACTION_ID"};
-        // Length of 'TRANSACTION_ID' string.
-        static constexpr auto transactionIdVarSize = transactionIdVar.size();
-        // Length of 'TRANSACTION_ID=' string.
-        static constexpr auto transactionIdVarOffset = transactionIdVarSize + 1;
+        journalSync.request(
+            std::bind(std::mem_fn(&Manager::finishCommit), this, id));
+    }
 
-        // Flush all the pending log messages into the journal
-        util::journalSync();
+    return id;
+}
 
-        sd_journal* j = nullptr;
-        int rc = sd_journal_open(&j, SD_JOURNAL_LOCAL_ONLY);
-        if (rc < 0)
-        {
-            lg2::error("Failed to open journal: {ERROR}", "ERROR",
-                       strerror(-rc));
-            return;
-        }
+void Manager::finishCommit(uint32_t id)
+{
+    auto commit = pendingCommits.extract(id);
+    if (commit.empty())
+    {
+        return;
+    }
 
-        std::string transactionIdStr = std::to_string(transactionId);
-        std::set<std::string> metalist;
-        auto metamap = g_errMetaMap.find(errMsg);
-        if (metamap != g_errMetaMap.end())
+    auto& [transactionId, errMsg, errLvl] = commit.mapped();
+
+    try
+    {
+        std::vector<std::string> additionalData;
+        if (!IS_UNIT_TEST)
         {
-            metalist.insert(metamap->second.begin(), metamap->second.end());
+            additionalData = harvestMetadata(transactionId, errMsg);
         }
+        createEntry(id, std::move(errMsg), errLvl, std::move(additionalData),
+                    FFDCEntries{});
+    }
+    catch (const std::exception& e)
+    {
+        lg2::error("Failed to create entry {ID} for a commit: {ERROR}", "ID",
+                   id, "ERROR", e);
+    }
+}
 
-        // Add _PID field information in AdditionalData.
-        metalist.insert("_PID");
-
-        // Read the journal from the end to get the most recent entry first.
-        // The result from the sd_journal_get_data() is of the form
-        // VARIABLE=value.
-        SD_JOURNAL_FOREACH_BACKWARDS(j)
-        {
-            const char* data = nullptr;
-            size_t length = 0;
+std::vector<std::string> Manager::harvestMetadata(uint64_t transactionId,
+                                                  const std::string& errMsg)
+{
+    std::set<std::string> metalist;
+    auto metamap = g_errMetaMap.find(errMsg);
+    if (metamap != g_errMetaMap.end())
+    {
+        metalist.insert(metamap->second.begin(), metamap->second.end());
+    }
 
-            // Look for the transaction id metadata variable
-            rc = sd_journal_get_data(j, transactionIdVar.data(),
-                                     (const void**)&data, &length);
-            if (rc < 0)
-            {
-                // This journal entry does not have the TRANSACTION_ID
-                // metadata variable.
-                continue;
-            }
+    // Add _PID field information in AdditionalData.
+    metalist.insert("_PID");
 
-            // journald does not guarantee that sd_journal_get_data() returns
-            // NULL terminated strings, so need to specify the size to use to
-            // compare, use the returned length instead of anything that relies
-            // on NULL terminators like strlen(). The data variable is in the
-            // form of 'TRANSACTION_ID=1234'. Remove the TRANSACTION_ID
-            // characters plus the (=) sign to do the comparison. 'data +
-            // transactionIdVarOffset' will be in the form of '1234'. 'length -
-            // transactionIdVarOffset' will be the length of '1234'.
-            if ((length <= (transactionIdVarOffset)) ||
-                (transactionIdStr.compare(
-                     0, transactionIdStr.size(), data + transactionIdVarOffset,
-                     length - transactionIdVarOffset) != 0))
-            {
-                // The value of the TRANSACTION_ID metadata is not the requested
-                // transaction id number.
-                continue;
-            }
+    auto additionalData = harvester.harvest(transactionId, metalist);
 
-            // Search for all metadata variables in the current journal entry.
-            for (auto i = metalist.cbegin(); i != metalist.cend();)
-            {
-                rc = sd_journal_get_data(j, (*i).c_str(), (const void**)&data,
-                                         &length);
-                if (rc < 0)
-                {
-                    // Metadata variable not found, check next metadata
-                    // variable.
-                    i++;
-                    continue;
-                }
-
-                // Metadata variable found, save it and remove it from the set.
-                additionalData.emplace_back(data, length);
-                i = metalist.erase(i);
-            }
-            if (metalist.empty())
-            {
-                // All metadata variables found, break out of journal loop.
-                break;
-            }
-        }
-        if (!metalist.empty())
+    if (!metalist.empty())
+    {
+        // Not all the metadata variables were found in the journal.
+        for (auto& metaVarStr : metalist)
         {
-            // Not all the metadata variables were found in the journal.
-            for (auto& metaVarStr : metalist)
-            {
-                lg2::info("Failed to find metadata: {META_FIELD}", "META_FIELD",
-                          metaVarStr);
-            }
+            lg2::info("Failed to find metadata: {META_FIELD}", "META_FIELD",
+                      metaVarStr);
         }
-
-        sd_journal_close(j);
     }
-    createEntry(errMsg, errLvl, additionalData);
+
+    return additionalData;
 }
 
 void Manager::createEntry(std::string errMsg, Entry::Level errLvl,
                           std::vector<std::string> additionalData,
                           const FFDCEntries& ffdc)
+{
+    createEntry(++entryId, std::move(errMsg), errLvl,
+                std::move(additionalData), ffdc);
+}
+
+void Manager::createEntry(uint32_t id, std::string errMsg,
+                          Entry::Level errLvl,
+                          std::vector<std::string> additionalData,
+                          const FFDCEntries& ffdc)
 {
     if (!Extensions::disableDefaultLogCaps())
     {
@@ -204,87 +213,119 @@ void Manager::createEntry(std::string errMsg, Entry::Level errLvl,
         {
             if (realErrors.size() >= ERROR_CAP)
             {
-                erase(realErrors.front());
+                erase(*realErrors.begin());
             }
         }
         else
         {
             if (infoErrors.size() >= ERROR_INFO_CAP)
             {
-                erase(infoErrors.front());
+                erase(*infoErrors.begin());
             }
         }
     }
 
-    entryId++;
-    if (errLvl >= Entry::sevLowerLimit)
-    {
-        infoErrors.push_back(entryId);
-    }
-    else
-    {
-        realErrors.push_back(entryId);
-    }
+    // An asynchronous commit may finish after entries with higher IDs were
+    // created, which the sets keep in order.
+    auto& ids = (errLvl >= Entry::sevLowerLimit) ? infoErrors : realErrors;
+    ids.insert(ids.end(), id);
+
     auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
                   std::chrono::system_clock::now().time_since_epoch())
                   .count();
-    auto objPath = std::string(OBJ_ENTRY) + '/' + std::to_string(entryId);
+    auto objPath = std::string(OBJ_ENTRY) + '/' + std::to_string(id);
 
     AssociationList objects{};
     processMetadata(errMsg, additionalData, objects);
 
     auto e = std::make_unique<Entry>(
-        busLog, objPath, entryId,
+        busLog, objPath, id,
         ms, // Milliseconds since 1970
         errLvl, std::move(errMsg), std::move(additionalData),
-        std::move(objects), fwVersion, getEntrySerializePath(entryId), *this);
+        std::move(objects), fwVersion, getEntrySerializePath(id), *this);
 
-    serialize(*e);
+    markDirty(e->id());
 
     if (isQuiesceOnErrorEnabled() && (errLvl < Entry::sevLowerLimit) &&
         isCalloutPresent(*e))
     {
-        quiesceOnError(entryId);
+        quiesceOnError(id);
     }
 
     // Add entry before calling the extensions so that they have access to it
-    entries.insert(std::make_pair(entryId, std::move(e)));
+    entries.insert(std::make_pair(id, std::move(e)));
 
-    doExtensionLogCreate(*entries.find(entryId)->second, ffdc);
+    doExtensionLogCreate(*entries.find(id)->second, ffdc);
 
     // Note: No need to close the file descriptors in the FFDC.
 }
 
-bool Manager::isQuiesceOnErrorEnabled()
+Manager::~Manager()
 {
-    // When running under tests, the Logging.Settings service will not be
-    // present.  Assume false.
-    if (IS_UNIT_TEST)
+    flushEntries();
+}
+
+void Manager::markDirty(uint32_t id)
+{
+    dirtyEntries.insert(id);
+
+    if (!flushSource)
     {
-        return false;
+        flushSource = std::make_unique<sdeventplus::source::Defer>(
+            sdeventplus::Event::get_default(),
+            std::bind(std::mem_fn(&Manager::onFlush), this,
+                      std::placeholders::_1));
     }
+}
 
-    std::variant<bool> property;
-
-    auto method = this->busLog.new_method_call(
-        "xyz.openbmc_project.Settings", "/xyz/openbmc_project/logging/settings",
-        "org.freedesktop.DBus.Properties", "Get");
+void Manager::writeDirtyEntries()
+{
+    for (auto id : std::exchange(dirtyEntries, {}))
+    {
+        if (auto entry = entries.find(id); entry != entries.end())
+        {
+            entryStore->save(*entry->second);
+        }
+    }
+}
 
-    method.append("xyz.openbmc_project.Logging.Settings", "QuiesceOnHwError");
+void Manager::flushEntries()
+{
+    writeDirtyEntries();
+    entryStore->sync();
+}
 
-    try
+void Manager::flushEntry(uint32_t id)
+{
+    if (dirtyEntries.erase(id) != 0)
     {
-        auto reply = this->busLog.call(method);
-        reply.read(property);
+        if (auto entry = entries.find(id); entry != entries.end())
+        {
+            entryStore->save(*entry->second);
+        }
     }
-    catch (const sdbusplus::exception_t& e)
+
+    entryStore->sync();
+}
+
+void Manager::onFlush(sdeventplus::source::EventBase& /*source*/)
+{
+    flushSource.reset();
+
+    // The store's group commit makes these durable shortly.
+    writeDirtyEntries();
+}
+
+bool Manager::isQuiesceOnErrorEnabled()
+{
+    // When running under tests, the Logging.Settings service will not be
+    // present.  Assume false.
+    if (IS_UNIT_TEST)
     {
-        lg2::error("Error reading QuiesceOnHwError property: {ERROR}", "ERROR",
-                   e);
         return false;
     }
 
-    return std::get<bool>(property);
+    return settings.quiesceOnHwError();
 }
 
 bool Manager::isCalloutPresent(const Entry& entry)
@@ -487,124 +528,257 @@ void Manager::checkAndRemoveBlockingError(uint32_t entryId)
     return;
 }
 
-void Manager::erase(uint32_t entryId)
+bool Manager::isDeleteProhibited(uint32_t entryId)
 {
-    auto entryFound = entries.find(entryId);
-    if (entries.end() != entryFound)
+    for (auto& func : Extensions::getDeleteProhibitedFunctions())
     {
-        for (auto& func : Extensions::getDeleteProhibitedFunctions())
+        try
         {
-            try
+            bool prohibited = false;
+            func(entryId, prohibited);
+            if (prohibited)
             {
-                bool prohibited = false;
-                func(entryId, prohibited);
-                if (prohibited)
-                {
-                    // Future work remains to throw an error here.
-                    return;
-                }
-            }
-            catch (const std::exception& e)
-            {
-                lg2::error("An extension's deleteProhibited function threw an "
-                           "exception: {ERROR}",
-                           "ERROR", e);
+                return true;
             }
         }
+        catch (const std::exception& e)
+        {
+            lg2::error("An extension's deleteProhibited function threw an "
+                       "exception: {ERROR}",
+                       "ERROR", e);
+        }
+    }
 
-        // Delete the persistent representation of this error.
-        fs::path errorPath(ERRLOG_PERSIST_PATH);
-        errorPath /= std::to_string(entryId);
-        fs::remove(errorPath);
+    return false;
+}
 
-        auto removeId = [](std::list<uint32_t>& ids, uint32_t id) {
-            auto it = std::find(ids.begin(), ids.end(), id);
-            if (it != ids.end())
-            {
-                ids.erase(it);
-            }
-        };
-        if (entryFound->second->severity() >= Entry::sevLowerLimit)
+void Manager::erase(uint32_t entryId)
+{
+    if (!entries.contains(entryId))
+    {
+        lg2::error("Invalid entry ID ({ID}) to delete", "ID", entryId);
+        return;
+    }
+
+    if (isDeleteProhibited(entryId))
+    {
+        // Future work remains to throw an error here.
+        return;
+    }
+
+    // Delete the persistent representation of this error.
+    dirtyEntries.erase(entryId);
+    entryStore->remove(entryId);
+
+    removeEntries({entryId});
+    doExtensionLogDelete({entryId});
+}
+
+void Manager::eraseAll()
+{
+    std::vector<uint32_t> ids;
+    ids.reserve(entries.size());
+    for (const auto& [id, entry] : entries)
+    {
+        if (!isDeleteProhibited(id))
         {
-            removeId(infoErrors, entryId);
+            ids.push_back(id);
         }
-        else
+    }
+
+    for (auto id : ids)
+    {
+        dirtyEntries.erase(id);
+    }
+    entryStore->removeBatch(ids);
+
+    removeEntries(ids);
+    doExtensionLogDelete(ids);
+
+    // IDs handed out to commits still in progress must not be reused.
+    if (pendingCommits.empty())
+    {
+        entryId = 0;
+    }
+}
+
+void Manager::removeEntries(const std::vector<uint32_t>& ids)
+{
+    // Hold on to the objects until the bookkeeping is done, so that their
+    // InterfacesRemoved signals all go out together.
+    std::vector<std::unique_ptr<Entry>> removed;
+    removed.reserve(ids.size());
+
+    for (auto id : ids)
+    {
+        auto entry = entries.find(id);
+        if (entry == entries.end())
         {
-            removeId(realErrors, entryId);
+            continue;
         }
-        entries.erase(entryFound);
 
-        checkAndRemoveBlockingError(entryId);
+        realErrors.erase(id);
+        infoErrors.erase(id);
+
+        removed.push_back(std::move(entry->second));
+        entries.erase(entry);
 
-        for (auto& remove : Extensions::getDeleteFunctions())
+        checkAndRemoveBlockingError(id);
+    }
+}
+
+void Manager::doExtensionLogDelete(const std::vector<uint32_t>& ids)
+{
+    if (ids.empty())
+    {
+        return;
+    }
+
+    for (auto& remove : Extensions::getDeleteBatchFunctions())
+    {
+        try
+        {
+            remove(ids);
+        }
+        catch (const std::exception& e)
+        {
+            lg2::error("An extension's delete batch function threw an "
+                       "exception: {ERROR}",
+                       "ERROR", e);
+        }
+    }
+
+    for (auto& remove : Extensions::getDeleteFunctions())
+    {
+        for (auto id : ids)
         {
             try
             {
-                remove(entryId);
+                remove(id);
             }
             catch (const std::exception& e)
             {
-                lg2::error("An extension's delete function threw an exception: "
-                           "{ERROR}",
+                lg2::error("An extension's delete function threw an "
+                           "exception: {ERROR}",
                            "ERROR", e);
             }
         }
     }
-    else
-    {
-        lg2::error("Invalid entry ID ({ID}) to delete", "ID", entryId);
-    }
 }
 
 void Manager::restore()
 {
-    auto sanity = [](const auto& id, const auto& restoredId) {
-        return id == restoredId;
+    auto start = steady_clock::now();
+    auto ids = entryStore->getIDs();
+    auto listed = steady_clock::now();
+
+    // Decoding is most of the work, and doesn't touch D-Bus, so spread it
+    // across threads.  The calling thread takes the first share.
+    std::vector<std::optional<EntryData>> decoded(ids.size());
+    auto decode = [this, &ids, &decoded](size_t first, size_t last) {
+        for (auto i = first; i < last; i++)
+        {
+            EntryData data;
+            if (entryStore->read(ids[i], data))
+            {
+                decoded[i] = std::move(data);
+            }
+        }
     };
 
-    fs::path dir(ERRLOG_PERSIST_PATH);
-    if (!fs::exists(dir) || fs::is_empty(dir))
+    size_t threads = std::clamp<size_t>(
+        ids.size() / minEntriesPerRestoreThread, 1,
+        std::max(std::thread::hardware_concurrency(), 1U));
+    size_t share = (ids.size() + threads - 1) / threads;
+
+    std::vector<std::thread> workers;
+    size_t first = share;
+    for (; first < ids.size(); first += share)
     {
-        return;
+        try
+        {
+            workers.emplace_back(decode, first,
+                                 std::min(first + share, ids.size()));
+        }
+        catch (const std::system_error& e)
+        {
+            lg2::error("Unable to start a restore thread: {ERROR}", "ERROR",
+                       e);
+            break;
+        }
     }
+    decode(0, std::min(share, ids.size()));
+
+    // Anything a thread couldn't be started for
+    decode(first, ids.size());
 
-    for (auto& file : fs::directory_iterator(dir))
+    for (auto& worker : workers)
     {
-        auto id = file.path().filename().c_str();
-        auto idNum = std::stol(id);
+        worker.join();
+    }
+    threads = workers.size() + 1;
+    auto decodedTime = steady_clock::now();
+
+    // Put all of the objects on the bus before any of the InterfacesAdded
+    // signals go out.
+    std::vector<Entry*> restored;
+    restored.reserve(ids.size());
+    for (size_t i = 0; i < ids.size(); i++)
+    {
+        auto idNum = ids[i];
+        if (!decoded[i])
+        {
+            lg2::error("Unable to restore error entry {ID_NUM}, removing it",
+                       "ID_NUM", idNum);
+            entryStore->remove(idNum);
+            continue;
+        }
+
+        // validate the restored error entry id
+        if (decoded[i]->id != idNum)
+        {
+            lg2::error("Failed in sanity check while restoring error entry. "
+                       "Ignoring error entry {ID_NUM}/{ENTRY_ID}.",
+                       "ID_NUM", idNum, "ENTRY_ID", decoded[i]->id);
+            continue;
+        }
+
         auto e = std::make_unique<Entry>(
-            busLog, std::string(OBJ_ENTRY) + '/' + id, idNum, *this);
-        if (deserialize(file.path(), *e))
+            busLog, std::string(OBJ_ENTRY) + '/' + std::to_string(idNum),
+            std::move(*decoded[i]), getEntrySerializePath(idNum), *this);
+        if (e->severity() >= Entry::sevLowerLimit)
         {
-            // validate the restored error entry id
-            if (sanity(static_cast<uint32_t>(idNum), e->id()))
-            {
-                e->path(file.path(), true);
-                if (e->severity() >= Entry::sevLowerLimit)
-                {
-                    infoErrors.push_back(idNum);
-                }
-                else
-                {
-                    realErrors.push_back(idNum);
-                }
-
-                entries.insert(std::make_pair(idNum, std::move(e)));
-            }
-            else
-            {
-                lg2::error(
-                    "Failed in sanity check while restoring error entry. "
-                    "Ignoring error entry {ID_NUM}/{ENTRY_ID}.",
-                    "ID_NUM", idNum, "ENTRY_ID", e->id());
-            }
+            infoErrors.insert(infoErrors.end(), idNum);
         }
+        else
+        {
+            realErrors.insert(realErrors.end(), idNum);
+        }
+
+        restored.push_back(e.get());
+        entries.emplace_hint(entries.end(), idNum, std::move(e));
+    }
+
+    for (auto e : restored)
+    {
+        e->emit_object_added();
     }
 
     if (!entries.empty())
     {
         entryId = entries.rbegin()->first;
     }
+
+    auto done = steady_clock::now();
+    auto ms = [](auto duration) {
+        return duration_cast<milliseconds>(duration).count();
+    };
+    lg2::info("Restored {COUNT} event logs in {TOTAL_MS}ms: listing took "
+              "{LIST_MS}ms, decoding on {THREADS} threads took {DECODE_MS}ms, "
+              "and registering on D-Bus took {REGISTER_MS}ms",
+              "COUNT", restored.size(), "TOTAL_MS", ms(done - start), "LIST_MS",
+              ms(listed - start), "THREADS", threads, "DECODE_MS",
+              ms(decodedTime - listed), "REGISTER_MS", ms(done - decodedTime));
 }
 
 std::string Manager::readFWVersion()
@@ -641,6 +815,133 @@ void Manager::createWithFFDC(
     createEntry(message, severity, ad, ffdc);
 }
 
+std::vector<uint32_t>
+    Manager::createBatch(const std::vector<BatchEvent>& events)
+{
+    std::vector<uint32_t> ids;
+    ids.reserve(events.size());
+
+    if (events.empty())
+    {
+        return ids;
+    }
+
+    auto isInfo = [](const BatchEvent& event) {
+        return std::get<Entry::Level>(event) >= Entry::sevLowerLimit;
+    };
+    size_t newInfo = std::count_if(events.begin(), events.end(), isInfo);
+    size_t newReal = events.size() - newInfo;
+
+    // Make room for the whole batch in one go instead of once per event.
+    if (!Extensions::disableDefaultLogCaps())
+    {
+        if (realErrors.size() + newReal > ERROR_CAP)
+        {
+            evict(realErrors, realErrors.size() + newReal - ERROR_CAP);
+        }
+        if (infoErrors.size() + newInfo > ERROR_INFO_CAP)
+        {
+            evict(infoErrors, infoErrors.size() + newInfo - ERROR_INFO_CAP);
+        }
+    }
+
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                  std::chrono::system_clock::now().time_since_epoch())
+                  .count();
+
+    std::vector<std::unique_ptr<Entry>> created;
+    created.reserve(events.size());
+
+    for (const auto& event : events)
+    {
+        const auto& [message, severity, additionalData] = event;
+
+        // Convert the map into a vector of "key=value" strings
+        std::vector<std::string> ad;
+        metadata::associations::combine(additionalData, ad);
+
+        auto id = ++entryId;
+        if (isInfo(event))
+        {
+            infoErrors.insert(infoErrors.end(), id);
+        }
+        else
+        {
+            realErrors.insert(realErrors.end(), id);
+        }
+
+        AssociationList objects{};
+        processMetadata(message, ad, objects);
+
+        created.push_back(std::make_unique<Entry>(
+            busLog, std::string(OBJ_ENTRY) + '/' + std::to_string(id), id,
+            ms, // Milliseconds since 1970
+            severity, std::string{message}, std::move(ad), std::move(objects),
+            fwVersion, getEntrySerializePath(id), *this));
+        ids.push_back(id);
+    }
+
+    for (const auto& e : created)
+    {
+        markDirty(e->id());
+    }
+
+    bool quiesce = (newReal != 0) && isQuiesceOnErrorEnabled();
+
+    for (auto& e : created)
+    {
+        auto id = e->id();
+        if (quiesce && (e->severity() < Entry::sevLowerLimit) &&
+            isCalloutPresent(*e))
+        {
+            quiesceOnError(id);
+        }
+
+        entries.insert(std::make_pair(id, std::move(e)));
+    }
+
+    // The whole batch is written and synced together, before any extension
+    // is told about it.
+    flushEntries();
+
+    // All entries are added before calling the extensions so that they
+    // have access to them.  Any journal syncs they do share one flush.
+    journalSync.coalesce([this, &ids]() {
+        for (auto id : ids)
+        {
+            doExtensionLogCreate(*entries.find(id)->second, FFDCEntries{});
+        }
+    });
+
+    // A batch larger than a cap pushes out its own oldest entries, just
+    // like the same events created one at a time would.
+    if (!Extensions::disableDefaultLogCaps())
+    {
+        if (realErrors.size() > ERROR_CAP)
+        {
+            evict(realErrors, realErrors.size() - ERROR_CAP);
+        }
+        if (infoErrors.size() > ERROR_INFO_CAP)
+        {
+            evict(infoErrors, infoErrors.size() - ERROR_INFO_CAP);
+        }
+    }
+
+    return ids;
+}
+
+void Manager::evict(std::set<uint32_t>& ids, size_t count)
+{
+    // erase() removes the ID from the set, so work from a copy.
+    std::vector<uint32_t> oldest(ids.begin(),
+                                 std::next(ids.begin(),
+                                           std::min(count, ids.size())));
+    for (auto id : oldest)
+    {
+        erase(id);
+    }
+}
+
 } // namespace internal
 } // namespace logging
 } // namespace phosphor
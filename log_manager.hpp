@@ -2,15 +2,22 @@
 
 #include "elog_block.hpp"
 #include "elog_entry.hpp"
+#include "entry_store.hpp"
+#include "journal_harvester.hpp"
+#include "journal_sync.hpp"
+#include "logging_settings.hpp"
 #include "xyz/openbmc_project/Collection/DeleteAll/server.hpp"
 #include "xyz/openbmc_project/Logging/Create/server.hpp"
+#include "xyz/openbmc_project/Logging/CreateBatch/server.hpp"
 #include "xyz/openbmc_project/Logging/Entry/server.hpp"
 #include "xyz/openbmc_project/Logging/Internal/Manager/server.hpp"
 
 #include <phosphor-logging/log.hpp>
 #include <sdbusplus/bus.hpp>
+#include <sdeventplus/source/event.hpp>
 
-#include <list>
+#include <map>
+#include <set>
 
 namespace phosphor
 {
@@ -21,6 +28,8 @@ extern const std::map<std::string, std::vector<std::string>> g_errMetaMap;
 extern const std::map<std::string, level> g_errLevelMap;
 
 using CreateIface = sdbusplus::server::xyz::openbmc_project::logging::Create;
+using CreateBatchIface =
+    sdbusplus::server::xyz::openbmc_project::logging::CreateBatch;
 using DeleteAllIface =
     sdbusplus::server::xyz::openbmc_project::collection::DeleteAll;
 
@@ -44,6 +53,11 @@ using FFDCEntry = std::tuple<CreateIface::FFDCFormat, uint8_t, uint8_t,
 
 using FFDCEntries = std::vector<FFDCEntry>;
 
+using BatchEvent = std::tuple<
+    std::string,
+    sdbusplus::server::xyz::openbmc_project::logging::Entry::Level,
+    std::map<std::string, std::string>>;
+
 namespace internal
 {
 
@@ -60,7 +74,9 @@ class Manager : public details::ServerObject<details::ManagerIface>
     Manager& operator=(const Manager&) = delete;
     Manager(Manager&&) = delete;
     Manager& operator=(Manager&&) = delete;
-    virtual ~Manager() = default;
+
+    /** @brief Destructor, which persists any entries still marked dirty. */
+    virtual ~Manager();
 
     /** @brief Constructor to put object onto bus at a dbus path.
      *  @param[in] bus - Bus to attach to.
@@ -68,13 +84,16 @@ class Manager : public details::ServerObject<details::ManagerIface>
      */
     Manager(sdbusplus::bus_t& bus, const char* objPath) :
         details::ServerObject<details::ManagerIface>(bus, objPath), busLog(bus),
+        entryStore(EntryStore::create()), journalSync(bus), settings(bus),
         entryId(0), fwVersion(readFWVersion()){};
 
     /*
      * @fn commit()
      * @brief sd_bus Commit method implementation callback.
      * @details Create an error/event log based on transaction id and
-     *          error message.
+     *          error message.  With asynchronous commits, the entry ID is
+     *          reserved and returned and the entry is created later from
+     *          the event loop.
      * @param[in] transactionId - Unique identifier of the journal entries
      *                            to be committed.
      * @param[in] errMsg - The error exception message associated with the
@@ -86,7 +105,9 @@ class Manager : public details::ServerObject<details::ManagerIface>
      * @fn commit()
      * @brief sd_bus CommitWithLvl method implementation callback.
      * @details Create an error/event log based on transaction id and
-     *          error message.
+     *          error message.  With asynchronous commits, the entry ID is
+     *          reserved and returned and the entry is created later from
+     *          the event loop.
      * @param[in] transactionId - Unique identifier of the journal entries
      *                            to be committed.
      * @param[in] errMsg - The error exception message associated with the
@@ -104,23 +125,24 @@ class Manager : public details::ServerObject<details::ManagerIface>
 
     /** @brief Construct error d-bus objects from their persisted
      *         representations.
+     *
+     *  The entries are decoded on a pool of threads, then all of the
+     *  objects are put on the bus before their InterfacesAdded signals are
+     *  sent.  How long each phase took is logged.
      */
     void restore();
 
+    /** @brief The fewest entries it's worth starting a restore thread for */
+    static constexpr size_t minEntriesPerRestoreThread = 32;
+
     /** @brief  Erase all error log entries
      *
+     *  Unlike calling erase() on each entry, the persisted entries are
+     *  removed in one pass, the d-bus objects are all taken off the bus
+     *  together at the end, and extensions get a single delete
+     *  notification for the whole set.
      */
-    void eraseAll()
-    {
-        auto iter = entries.begin();
-        while (iter != entries.end())
-        {
-            auto e = iter->first;
-            ++iter;
-            erase(e);
-        }
-        entryId = 0;
-    }
+    void eraseAll();
 
     /** @brief Returns the count of high severity errors
      *
@@ -163,7 +185,59 @@ class Manager : public details::ServerObject<details::ManagerIface>
     }
 
     /**
-     * @brief Returns the ID of the last created entry
+     * @brief Returns where entries are persisted
+     *
+     * @return EntryStore&
+     */
+    EntryStore& getEntryStore()
+    {
+        return *entryStore;
+    }
+
+    /**
+     * @brief Returns the journal sync service
+     *
+     * @return JournalSync&
+     */
+    JournalSync& getJournalSync()
+    {
+        return journalSync;
+    }
+
+    /** @brief Mark an entry as needing to be persisted.
+     *
+     *  Entries are written from the event loop, once no matter how many
+     *  times they were marked in the meantime, so several property changes
+     *  in a row only cost one write.
+     *
+     *  @param[in] id - The entry ID
+     */
+    void markDirty(uint32_t id);
+
+    /** @brief Persist every entry marked dirty and make it durable now,
+     *         instead of waiting for the event loop.
+     */
+    void flushEntries();
+
+    /** @brief Persist an entry if it is marked dirty and make it durable
+     *         now.
+     *
+     *  @param[in] id - The entry ID
+     */
+    void flushEntry(uint32_t id);
+
+    /**
+     * @brief Returns the cached Logging.Settings properties
+     *
+     * @return LoggingSettings&
+     */
+    LoggingSettings& getSettings()
+    {
+        return settings;
+    }
+
+    /**
+     * @brief Returns the ID of the last created or reserved entry
      *
      * @return uint32_t - The ID
      */
@@ -207,7 +281,22 @@ class Manager : public details::ServerObject<details::ManagerIface>
         const std::map<std::string, std::string>& additionalData,
         const FFDCEntries& ffdc);
 
-    /** @brief Common wrapper for creating an Entry object
+    /** @brief Creates several event logs at once
+     *
+     * The result is the same as calling create() for each event in turn,
+     * but the log caps are checked once for the whole batch, the quiesce
+     * setting is only read once, and every new entry is persisted before
+     * any extension is told about them.
+     *
+     * @param[in] events - The message, severity, and additional data of
+     *                     each event log
+     *
+     * @return The IDs of the new entries, in the order of the events
+     */
+    std::vector<uint32_t> createBatch(const std::vector<BatchEvent>& events);
+
+    /** @brief Check if the QuiesceOnHwError setting is enabled.  This
+     *         reads a cached copy of the setting, so it is cheap to call.
      *
      * @return true if quiesce on error setting is enabled, false otherwise
      */
@@ -236,7 +325,45 @@ class Manager : public details::ServerObject<details::ManagerIface>
     /** @brief Persistent map of Entry dbus objects and their ID */
     std::map<uint32_t, std::unique_ptr<Entry>> entries;
 
+  protected:
+    /*
+     * @fn queueCommit()
+     * @brief Reserves an entry ID for the commit and schedules the entry
+     *        to be created once the journal has been synced.
+     * @param[in] transactionId - Unique identifier of the journal entries
+     *                            to be committed.
+     * @param[in] errMsg - The error exception message associated with the
+     *                     error log to be committed.
+     * @param[in] errLvl - level of the error
+     *
+     * @return uint32_t - The reserved entry ID
+     */
+    uint32_t queueCommit(uint64_t transactionId, std::string&& errMsg,
+                         Entry::Level errLvl);
+
+    /** @brief Creates the entry of a queued commit.  Called from the event
+     *         loop once the journal has been synced.
+     *
+     *  Unit tests call this themselves, as they don't sync the journal.
+     *
+     *  @param[in] id - The reserved entry ID
+     */
+    void finishCommit(uint32_t id);
+
   private:
+    /** @brief A commit whose entry hasn't been created yet */
+    struct PendingCommit
+    {
+        /** @brief The TRANSACTION_ID of the journal entries */
+        uint64_t transactionId;
+
+        /** @brief The error message */
+        std::string errMsg;
+
+        /** @brief The severity */
+        Entry::Level errLvl;
+    };
+
     /*
      * @fn _commit()
      * @brief commit() helper
@@ -249,6 +376,17 @@ class Manager : public details::ServerObject<details::ManagerIface>
     void _commit(uint64_t transactionId, std::string&& errMsg,
                  Entry::Level errLvl);
 
+    /** @brief Reads the metadata of an error out of the journal.
+     *
+     *  @param[in] transactionId - Unique identifier of the journal entries
+     *  @param[in] errMsg - The error message, used to look up the metadata
+     *                      fields it has.
+     *
+     *  @return The metadata, in VARIABLE=value format
+     */
+    std::vector<std::string> harvestMetadata(uint64_t transactionId,
+                                             const std::string& errMsg);
+
     /** @brief Call metadata handler(s), if any. Handlers may create
      *         associations.
      *  @param[in] errorName - name of the error
@@ -287,6 +425,48 @@ class Manager : public details::ServerObject<details::ManagerIface>
                      std::vector<std::string> additionalData,
                      const FFDCEntries& ffdc = FFDCEntries{});
 
+    /** @brief Creates an Entry object with an ID that was already reserved
+     *
+     * @param[in] id - The entry ID
+     * @param[in] errMsg - The error exception message associated with the
+     *                     error log to be committed.
+     * @param[in] errLvl - level of the error
+     * @param[in] additionalData - The AdditionalData property for the error
+     * @param[in] ffdc - A vector of FFDC file info
+     */
+    void createEntry(uint32_t id, std::string errMsg, Entry::Level errLvl,
+                     std::vector<std::string> additionalData,
+                     const FFDCEntries& ffdc);
+
+    /** @brief Erases the oldest entries in an eviction set
+     *
+     * @param[in] ids - realErrors or infoErrors
+     * @param[in] count - How many to erase
+     */
+    void evict(std::set<uint32_t>& ids, size_t count);
+
+    /** @brief Asks the extensions if an entry may be deleted
+     *
+     * @param[in] entryId - The entry ID
+     *
+     * @return true if an extension prohibits deleting it
+     */
+    bool isDeleteProhibited(uint32_t entryId);
+
+    /** @brief Drops deleted entries from the bookkeeping and takes their
+     *         d-bus objects off the bus.  The persisted entries must
+     *         already be removed.
+     *
+     * @param[in] ids - The entry IDs
+     */
+    void removeEntries(const std::vector<uint32_t>& ids);
+
+    /** @brief Calls the extensions' delete functions
+     *
+     * @param[in] ids - The IDs of the deleted entries
+     */
+    void doExtensionLogDelete(const std::vector<uint32_t>& ids);
+
     /** @brief Notified on entry property changes
      *
      * If an entry is blocking, this callback will be registered to monitor for
@@ -307,18 +487,49 @@ class Manager : public details::ServerObject<details::ManagerIface>
      */
     void checkAndQuiesceHost();
 
+    /** @brief Persists the dirty entries, from the event loop.
+     *
+     * @param[in] source - The event source
+     */
+    void onFlush(sdeventplus::source::EventBase& source);
+
+    /** @brief Saves the dirty entries to the store, leaving them to its
+     *         group commit. */
+    void writeDirtyEntries();
+
     /** @brief Persistent sdbusplus DBus bus connection. */
     sdbusplus::bus_t& busLog;
 
-    /** @brief List of error ids for high severity errors */
-    std::list<uint32_t> realErrors;
+    /** @brief Where entries are persisted */
+    std::unique_ptr<EntryStore> entryStore;
+
+    /** @brief Flushes the journal before metadata is read from it. */
+    JournalSync journalSync;
 
-    /** @brief List of error ids for Info(and below) severity */
-    std::list<uint32_t> infoErrors;
+    /** @brief The cached Logging.Settings properties */
+    LoggingSettings settings;
+
+    /** @brief IDs of the entries waiting to be persisted */
+    std::set<uint32_t> dirtyEntries;
+
+    /** @brief Persists the dirty entries from the event loop */
+    std::unique_ptr<sdeventplus::source::Defer> flushSource;
+
+    /** @brief Reads commit metadata out of the journal. */
+    JournalHarvester harvester;
+
+    /** @brief Error ids for high severity errors, oldest first */
+    std::set<uint32_t> realErrors;
+
+    /** @brief Error ids for Info(and below) severity, oldest first */
+    std::set<uint32_t> infoErrors;
 
     /** @brief Id of last error log entry */
     uint32_t entryId;
 
+    /** @brief Commits waiting on a journal sync, by reserved entry ID */
+    std::map<uint32_t, PendingCommit> pendingCommits;
+
     /** @brief The BMC firmware version */
     const std::string fwVersion;
 
@@ -336,10 +547,12 @@ class Manager : public details::ServerObject<details::ManagerIface>
  *  @brief Implementation for deleting all error log entries and
  *         creating new logs.
  *  @details A concrete implementation for the
- *           xyz.openbmc_project.Collection.DeleteAll and
- *           xyz.openbmc_project.Logging.Create interfaces.
+ *           xyz.openbmc_project.Collection.DeleteAll,
+ *           xyz.openbmc_project.Logging.Create, and
+ *           xyz.openbmc_project.Logging.CreateBatch interfaces.
  */
-class Manager : public details::ServerObject<DeleteAllIface, CreateIface>
+class Manager :
+    public details::ServerObject<DeleteAllIface, CreateIface, CreateBatchIface>
 {
   public:
     Manager() = delete;
@@ -358,10 +571,10 @@ class Manager : public details::ServerObject<DeleteAllIface, CreateIface>
      */
     Manager(sdbusplus::bus_t& bus, const std::string& path,
             internal::Manager& manager) :
-        details::ServerObject<DeleteAllIface, CreateIface>(
+        details::ServerObject<DeleteAllIface, CreateIface, CreateBatchIface>(
             bus, path.c_str(),
-            details::ServerObject<DeleteAllIface,
-                                  CreateIface>::action::defer_emit),
+            details::ServerObject<DeleteAllIface, CreateIface,
+                                  CreateBatchIface>::action::defer_emit),
         manager(manager){};
 
     /** @brief Delete all d-bus objects.
@@ -408,6 +621,19 @@ class Manager : public details::ServerObject<DeleteAllIface, CreateIface>
         manager.createWithFFDC(message, severity, additionalData, ffdc);
     }
 
+    /** @brief D-Bus method call implementation to create several event
+     *         logs at once.
+     *
+     * @param[in] events - The message, severity, and additional data of
+     *                     each event log
+     *
+     * @return The IDs of the new entries
+     */
+    std::vector<uint32_t> createBatch(std::vector<BatchEvent> events) override
+    {
+        return manager.createBatch(events);
+    }
+
   private:
     /** @brief This is a reference to manager object */
     internal::Manager& manager;
@@ -10,11 +10,17 @@
 #include <sdbusplus/server/manager.hpp>
 #include <sdeventplus/event.hpp>
 
+#include <chrono>
 #include <filesystem>
 
 int main(int /*argc*/, char* /*argv*/[])
 {
     PHOSPHOR_LOG2_USING_WITH_FLAGS;
+    using std::chrono::duration_cast;
+    using std::chrono::milliseconds;
+    using std::chrono::steady_clock;
+
+    auto start = steady_clock::now();
 
     auto bus = sdbusplus::bus::new_default();
     auto event = sdeventplus::Event::get_default();
@@ -31,7 +37,9 @@ int main(int /*argc*/, char* /*argv*/[])
     std::filesystem::create_directories(ERRLOG_PERSIST_PATH);
 
     // Recreate error d-bus objects from persisted errors.
+    auto restoreStart = steady_clock::now();
     iMgr.restore();
+    auto extensionsStart = steady_clock::now();
 
     for (auto& startup : phosphor::logging::Extensions::getStartupFunctions())
     {
@@ -48,5 +56,16 @@ int main(int /*argc*/, char* /*argv*/[])
 
     bus.request_name(BUSNAME_LOGGING);
 
+    auto ready = steady_clock::now();
+    auto ms = [](auto duration) {
+        return duration_cast<milliseconds>(duration).count();
+    };
+    info("Logging service ready in {TOTAL_MS}ms: setup took {SETUP_MS}ms, "
+         "restore took {RESTORE_MS}ms, and extension startup took "
+         "{EXTENSIONS_MS}ms",
+         "TOTAL_MS", ms(ready - start), "SETUP_MS", ms(restoreStart - start),
+         "RESTORE_MS", ms(extensionsStart - restoreStart), "EXTENSIONS_MS",
+         ms(ready - extensionsStart));
+
     return event.loop();
 }
@@ -0,0 +1,723 @@
+#include "config.h"
+
+#include "log_store.hpp"
+
+#include "elog_serialize.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <phosphor-logging/lg2.hpp>
+#include <sdeventplus/event.hpp>
+
+#include <array>
+#include <charconv>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+namespace phosphor
+{
+namespace logging
+{
+
+namespace
+{
+
+/** @brief "ELOG" */
+constexpr uint32_t recordMagic = 0x474f4c45;
+
+constexpr auto segmentExtension = ".seg";
+constexpr auto tempExtension = ".tmp";
+
+constexpr std::array<uint32_t, 256> crcTable = []() {
+    std::array<uint32_t, 256> table{};
+    for (uint32_t i = 0; i < table.size(); i++)
+    {
+        uint32_t c = i;
+        for (int k = 0; k < 8; k++)
+        {
+            c = (c & 1) ? (0xEDB88320 ^ (c >> 1)) : (c >> 1);
+        }
+        table[i] = c;
+    }
+    return table;
+}();
+
+/** @brief CRC32 (IEEE 802.3), which can be chained across buffers */
+uint32_t crc32(const void* data, size_t size, uint32_t crc = 0)
+{
+    auto p = static_cast<const uint8_t*>(data);
+    crc = ~crc;
+    for (size_t i = 0; i < size; i++)
+    {
+        crc = crcTable[(crc ^ p[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+/** @brief Parses a file name that is only a number */
+std::optional<uint32_t> toNumber(const std::string& name)
+{
+    uint32_t number{};
+    auto [ptr, ec] = std::from_chars(name.data(), name.data() + name.size(),
+                                     number);
+    if ((ec != std::errc{}) || (ptr != name.data() + name.size()))
+    {
+        return std::nullopt;
+    }
+    return number;
+}
+
+std::optional<std::string> readFile(const fs::path& path)
+{
+    std::ifstream file{path, std::ios::in | std::ios::binary};
+    if (!file.good())
+    {
+        return std::nullopt;
+    }
+    return std::string{std::istreambuf_iterator<char>(file),
+                       std::istreambuf_iterator<char>()};
+}
+
+bool writeAll(int fd, const std::string& data)
+{
+    size_t written = 0;
+    while (written < data.size())
+    {
+        auto rc = write(fd, data.data() + written, data.size() - written);
+        if (rc < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return false;
+        }
+        written += rc;
+    }
+    return true;
+}
+
+} // namespace
+
+LogStore::~LogStore()
+{
+    sync();
+
+    if (fd != -1)
+    {
+        close(fd);
+    }
+}
+
+void LogStore::commit()
+{
+    // Every record since the last commit is in the newest segment, since
+    // a segment is committed before it is closed.
+    if ((fd != -1) && (fdatasync(fd) != 0))
+    {
+        lg2::error("Failed to sync the event log store: {ERROR}", "ERROR",
+                   strerror(errno));
+    }
+}
+
+fs::path LogStore::getSegmentPath(uint32_t segment) const
+{
+    return dir / (std::to_string(segment) + segmentExtension);
+}
+
+uint64_t LogStore::getSize(const Records& records)
+{
+    return records.entry.size + (records.update ? records.update->size : 0);
+}
+
+uint64_t LogStore::getTotalSize() const
+{
+    uint64_t total = 0;
+    for (const auto& [segment, size] : segments)
+    {
+        total += size;
+    }
+    return total;
+}
+
+void LogStore::openStore()
+{
+    if (opened)
+    {
+        return;
+    }
+    opened = true;
+
+    std::error_code ec;
+    fs::create_directories(dir, ec);
+    if (ec)
+    {
+        lg2::error("Failed to create event log store {PATH}: {ERROR}", "PATH",
+                   dir.string(), "ERROR", ec.message());
+        return;
+    }
+
+    for (const auto& file : fs::directory_iterator(dir, ec))
+    {
+        const auto& path = file.path();
+        if (path.extension() == tempExtension)
+        {
+            // Left behind by a compaction that didn't finish.
+            fs::remove(path, ec);
+            continue;
+        }
+
+        auto segment = toNumber(path.stem().string());
+        if ((path.extension() == segmentExtension) && segment)
+        {
+            segments.emplace(*segment, 0);
+        }
+    }
+
+    if (!segments.empty())
+    {
+        auto newest = segments.rbegin()->first;
+        for (auto& [segment, size] : segments)
+        {
+            replay(segment, segment == newest);
+        }
+    }
+
+    migrate();
+}
+
+void LogStore::replay(uint32_t segment, bool newest)
+{
+    auto path = getSegmentPath(segment);
+    auto data = readFile(path);
+    if (!data)
+    {
+        lg2::error("Failed to read event log store segment {PATH}", "PATH",
+                   path.string());
+        return;
+    }
+
+    uint64_t offset = 0;
+    uint64_t validEnd = 0;
+    uint64_t validSize = 0;
+
+    while (offset + sizeof(RecordHeader) <= data->size())
+    {
+        RecordHeader header;
+        memcpy(&header, data->data() + offset, sizeof(header));
+        uint64_t total = sizeof(header) + header.size;
+
+        if ((header.magic == recordMagic) && (offset + total <= data->size()))
+        {
+            auto crc = header.crc;
+            header.crc = 0;
+            if (crc == crc32(data->data() + offset + sizeof(header),
+                             header.size, crc32(&header, sizeof(header))))
+            {
+                apply(static_cast<RecordType>(header.type), header.id,
+                      {segment, offset, static_cast<uint32_t>(total)});
+                offset += total;
+                validEnd = offset;
+                validSize += total;
+                continue;
+            }
+        }
+
+        // Damaged, so look for the next record after it.
+        offset++;
+    }
+
+    uint64_t size = data->size();
+    if (validSize != size)
+    {
+        lg2::error("Skipped {SIZE} damaged bytes in event log store segment "
+                   "{PATH}",
+                   "SIZE", size - validSize, "PATH", path.string());
+
+        // Cut off a torn write at the end so appends start on a record
+        // boundary.
+        if (newest && (validEnd != size))
+        {
+            if (truncate(path.c_str(), validEnd) == 0)
+            {
+                size = validEnd;
+            }
+            else
+            {
+                lg2::error("Failed to truncate {PATH}: {ERROR}", "PATH",
+                           path.string(), "ERROR", strerror(errno));
+            }
+        }
+    }
+
+    segments[segment] = size;
+}
+
+void LogStore::apply(RecordType type, uint32_t id, const Location& location)
+{
+    auto records = index.find(id);
+
+    switch (type)
+    {
+        case RecordType::entry:
+            if (records != index.end())
+            {
+                liveSize -= getSize(records->second);
+                records->second = Records{location, std::nullopt};
+            }
+            else
+            {
+                index.emplace(id, Records{location, std::nullopt});
+            }
+            liveSize += location.size;
+            break;
+        case RecordType::update:
+            // Updates to entries that were since erased are dead.
+            if (records != index.end())
+            {
+                if (records->second.update)
+                {
+                    liveSize -= records->second.update->size;
+                }
+                records->second.update = location;
+                liveSize += location.size;
+            }
+            break;
+        case RecordType::erased:
+            if (records != index.end())
+            {
+                liveSize -= getSize(records->second);
+                index.erase(records);
+            }
+            break;
+        default:
+            lg2::error("Unknown event log store record type {TYPE}", "TYPE",
+                       static_cast<uint8_t>(type));
+            break;
+    }
+}
+
+void LogStore::migrate()
+{
+    std::error_code ec;
+    if (!fs::is_directory(legacyDir, ec))
+    {
+        return;
+    }
+
+    std::vector<fs::path> migrated;
+    for (const auto& file : fs::directory_iterator(legacyDir, ec))
+    {
+        auto id = toNumber(file.path().filename().string());
+        if (!id)
+        {
+            continue;
+        }
+
+        // If it's already there, the last migration was interrupted
+        // before the file could be removed.
+        if (!index.contains(*id))
+        {
+            auto data = readFile(file.path());
+            if (!data)
+            {
+                continue;
+            }
+
+            // Entry files are already in the entry record format.
+            auto location = append(RecordType::entry, *id, *data);
+            if (!location)
+            {
+                // Try again on the next start.
+                return;
+            }
+            apply(RecordType::entry, *id, *location);
+        }
+
+        migrated.push_back(file.path());
+    }
+
+    if (migrated.empty())
+    {
+        return;
+    }
+
+    // Make sure the entries are in the log before their files go away.
+    if ((fd == -1) || (fsync(fd) != 0))
+    {
+        lg2::error("Failed to sync the event log store, keeping entry files");
+        return;
+    }
+
+    for (const auto& path : migrated)
+    {
+        fs::remove(path, ec);
+    }
+
+    lg2::info("Moved {COUNT} event log entry files into the log store",
+              "COUNT", migrated.size());
+}
+
+std::optional<LogStore::Location>
+    LogStore::append(RecordType type, uint32_t id, const std::string& payload)
+{
+    RecordHeader header{};
+    header.magic = recordMagic;
+    header.type = static_cast<uint8_t>(type);
+    header.id = id;
+    header.size = payload.size();
+    header.crc = crc32(payload.data(), payload.size(),
+                       crc32(&header, sizeof(header)));
+
+    std::string record(reinterpret_cast<const char*>(&header), sizeof(header));
+    record += payload;
+
+    // Start a new segment if this one is full.
+    if (segments.empty() || ((segments.rbegin()->second != 0) &&
+                             (segments.rbegin()->second + record.size() >
+                              segmentSize)))
+    {
+        if (fd != -1)
+        {
+            groupCommit.commitNow();
+            close(fd);
+            fd = -1;
+        }
+        segments.emplace(segments.empty() ? 1 : segments.rbegin()->first + 1,
+                         0);
+    }
+
+    auto& [segment, size] = *segments.rbegin();
+
+    if (fd == -1)
+    {
+        auto path = getSegmentPath(segment);
+        fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC,
+                    0644);
+        if (fd < 0)
+        {
+            lg2::error("Failed to open event log store segment {PATH}: "
+                       "{ERROR}",
+                       "PATH", path.string(), "ERROR", strerror(errno));
+            fd = -1;
+            return std::nullopt;
+        }
+    }
+
+    Location location{segment, size, static_cast<uint32_t>(record.size())};
+
+    if (!writeAll(fd, record))
+    {
+        lg2::error("Failed to write to the event log store: {ERROR}", "ERROR",
+                   strerror(errno));
+
+        // Whatever made it out is skipped when the segment is read back,
+        // but appends have to go after it.
+        size = lseek(fd, 0, SEEK_END);
+        return std::nullopt;
+    }
+
+    size += record.size();
+    groupCommit.add();
+    return location;
+}
+
+std::optional<std::string>
+    LogStore::readRecord(const Location& location) const
+{
+    auto path = getSegmentPath(location.segment);
+    int segmentFD = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (segmentFD < 0)
+    {
+        lg2::error("Failed to open event log store segment {PATH}: {ERROR}",
+                   "PATH", path.string(), "ERROR", strerror(errno));
+        return std::nullopt;
+    }
+
+    std::string record(location.size, '\0');
+    auto rc = pread(segmentFD, record.data(), record.size(), location.offset);
+    close(segmentFD);
+
+    RecordHeader header;
+    if ((rc != static_cast<ssize_t>(record.size())) ||
+        (record.size() < sizeof(header)))
+    {
+        lg2::error("Failed to read event log store segment {PATH}", "PATH",
+                   path.string());
+        return std::nullopt;
+    }
+
+    memcpy(&header, record.data(), sizeof(header));
+    auto crc = header.crc;
+    header.crc = 0;
+    if ((header.magic != recordMagic) ||
+        (sizeof(header) + header.size != record.size()) ||
+        (crc != crc32(record.data() + sizeof(header), header.size,
+                      crc32(&header, sizeof(header)))))
+    {
+        lg2::error("Bad event log store record in {PATH} at {OFFSET}", "PATH",
+                   path.string(), "OFFSET", location.offset);
+        return std::nullopt;
+    }
+
+    return record;
+}
+
+std::optional<std::string> LogStore::read(const Location& location) const
+{
+    auto record = readRecord(location);
+    if (!record)
+    {
+        return std::nullopt;
+    }
+    return record->substr(sizeof(RecordHeader));
+}
+
+void LogStore::save(const Entry& e)
+{
+    openStore();
+
+    // Only the properties that can change are written after the first time.
+    auto type = index.contains(e.id()) ? RecordType::update
+                                       : RecordType::entry;
+    auto payload = (type == RecordType::entry) ? serializeToString(e)
+                                               : serializeUpdatesToString(e);
+
+    if (auto location = append(type, e.id(), payload); location)
+    {
+        apply(type, e.id(), *location);
+    }
+
+    scheduleCompaction();
+}
+
+bool LogStore::read(uint32_t id, EntryData& data)
+{
+    openStore();
+
+    auto records = index.find(id);
+    if (records == index.end())
+    {
+        return false;
+    }
+
+    auto entry = read(records->second.entry);
+    if (!entry || !deserializeFromString(*entry, data))
+    {
+        lg2::error("Unable to read event log {ID} from the log store", "ID",
+                   id);
+        return false;
+    }
+
+    if (records->second.update)
+    {
+        auto update = read(*records->second.update);
+        if (!update || !deserializeUpdatesFromString(*update, data))
+        {
+            lg2::error("Unable to read the latest properties of event log "
+                       "{ID} from the log store",
+                       "ID", id);
+        }
+    }
+
+    return true;
+}
+
+void LogStore::remove(uint32_t id)
+{
+    openStore();
+
+    if (!index.contains(id))
+    {
+        return;
+    }
+
+    // Even if the record can't be written, it's gone for this boot.
+    append(RecordType::erased, id, {});
+    apply(RecordType::erased, id, {});
+
+    scheduleCompaction();
+}
+
+std::vector<uint32_t> LogStore::getIDs()
+{
+    openStore();
+
+    std::vector<uint32_t> ids;
+    ids.reserve(index.size());
+    for (const auto& [id, records] : index)
+    {
+        ids.push_back(id);
+    }
+    return ids;
+}
+
+int LogStore::open(const Entry& e)
+{
+    // There is no file per entry, so hand out a copy in the entry file
+    // format.
+    int memFD = memfd_create("phosphor-logging-entry", MFD_CLOEXEC);
+    if (memFD < 0)
+    {
+        return -1;
+    }
+
+    if (!writeAll(memFD, serializeToString(e)) ||
+        (lseek(memFD, 0, SEEK_SET) < 0))
+    {
+        auto err = errno;
+        close(memFD);
+        errno = err;
+        return -1;
+    }
+
+    return memFD;
+}
+
+void LogStore::scheduleCompaction()
+{
+    // Wait until superseded records are most of the store.
+    auto total = getTotalSize();
+    if ((total <= segmentSize) || (total <= 2 * liveSize))
+    {
+        return;
+    }
+
+    if (!compactTimer)
+    {
+        compactTimer = std::make_unique<
+            sdeventplus::utility::Timer<sdeventplus::ClockId::Monotonic>>(
+            sdeventplus::Event::get_default(),
+            std::bind(std::mem_fn(&LogStore::compact), this));
+    }
+
+    if (!compactTimer->isEnabled())
+    {
+        compactTimer->restartOnce(compactDelay);
+    }
+}
+
+void LogStore::compact()
+{
+    openStore();
+
+    if (segments.empty())
+    {
+        return;
+    }
+
+    auto before = getTotalSize();
+    auto target = segments.rbegin()->first + 1;
+    auto path = getSegmentPath(target);
+    auto tempPath = path;
+    tempPath += tempExtension;
+
+    int out = ::open(tempPath.c_str(),
+                     O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (out < 0)
+    {
+        lg2::error("Failed to create {PATH}: {ERROR}", "PATH",
+                   tempPath.string(), "ERROR", strerror(errno));
+        return;
+    }
+
+    std::map<uint32_t, Records> compacted;
+    uint64_t offset = 0;
+    bool failed = false;
+
+    // Records are copied as is, since nothing in them depends on where
+    // they are.
+    auto copy = [&](const Location& location) -> std::optional<Location> {
+        auto record = readRecord(location);
+        if (!record)
+        {
+            return std::nullopt;
+        }
+        if (!writeAll(out, *record))
+        {
+            failed = true;
+            return std::nullopt;
+        }
+        Location moved{target, offset, location.size};
+        offset += location.size;
+        return moved;
+    };
+
+    for (const auto& [id, records] : index)
+    {
+        auto entry = copy(records.entry);
+        if (failed)
+        {
+            break;
+        }
+        if (!entry)
+        {
+            lg2::error("Dropping unreadable event log {ID} from the log store",
+                       "ID", id);
+            continue;
+        }
+
+        Records moved{*entry, std::nullopt};
+        if (records.update)
+        {
+            moved.update = copy(*records.update);
+            if (failed)
+            {
+                break;
+            }
+        }
+        compacted.emplace(id, moved);
+    }
+
+    std::error_code ec;
+    if (failed || (fsync(out) != 0))
+    {
+        lg2::error("Failed to write {PATH}: {ERROR}", "PATH",
+                   tempPath.string(), "ERROR", strerror(errno));
+        close(out);
+        fs::remove(tempPath, ec);
+        return;
+    }
+    close(out);
+
+    fs::rename(tempPath, path, ec);
+    if (ec)
+    {
+        lg2::error("Failed to rename {PATH}: {ERROR}", "PATH",
+                   tempPath.string(), "ERROR", ec.message());
+        fs::remove(tempPath, ec);
+        return;
+    }
+
+    // The new segment has to stick before the old ones are deleted.
+    int dirFD = ::open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dirFD >= 0)
+    {
+        fsync(dirFD);
+        close(dirFD);
+    }
+
+    if (fd != -1)
+    {
+        close(fd);
+        fd = -1;
+    }
+
+    for (const auto& [segment, size] : segments)
+    {
+        fs::remove(getSegmentPath(segment), ec);
+    }
+
+    segments = {{target, offset}};
+    index = std::move(compacted);
+    liveSize = offset;
+
+    lg2::info("Compacted the event log store from {BEFORE} to {AFTER} bytes",
+              "BEFORE", before, "AFTER", offset);
+}
+
+} // namespace logging
+} // namespace phosphor
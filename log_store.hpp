@@ -0,0 +1,254 @@
+#pragma once
+
+#include "entry_store.hpp"
+
+#include <sdeventplus/clock.hpp>
+#include <sdeventplus/utility/timer.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace phosphor
+{
+namespace logging
+{
+
+namespace fs = std::filesystem;
+
+/** @class LogStore
+ *  @brief Persists entries in an append-only, segmented log.
+ *  @details Instead of a file per entry that is rewritten on every property
+ *           change, every change is appended as a record to the newest
+ *           segment file in the store directory:
+ *
+ *           - An entry record holds a whole entry, in the same format as
+ *             the cereal entry files.
+ *           - An update record holds just the properties that can change
+ *             after an entry is created.  The newest one wins.
+ *           - An erased record marks the entry as deleted.
+ *
+ *           Appends are synced with one fdatasync() per group commit.
+ *           Every record has a CRC32, and records that fail it are skipped
+ *           when the store is read back.  A torn record at the end of the
+ *           newest segment, left by a power loss during a write, is cut off.
+ *
+ *           Once most of the bytes in the store belong to records that have
+ *           been superseded, the live records are copied into a new segment
+ *           from the event loop and the old segments are deleted.
+ *
+ *           Entry files left in the legacy directory by the file store are
+ *           moved into the log the first time it is opened.
+ */
+class LogStore : public EntryStore
+{
+  public:
+    LogStore() = delete;
+
+    /** @brief Constructor
+     *
+     *  Nothing is read from or written to the directory until the store
+     *  is first used.
+     *
+     *  @param[in] dir - The directory of the segment files
+     *  @param[in] legacyDir - The directory of the entry files to migrate
+     *  @param[in] segmentSize - The size to start a new segment at
+     */
+    LogStore(const fs::path& dir, const fs::path& legacyDir,
+             size_t segmentSize = defaultSegmentSize) :
+        dir(dir), legacyDir(legacyDir), segmentSize(segmentSize)
+    {}
+
+    /** @brief Destructor, which commits any pending records */
+    ~LogStore() override;
+
+    void save(const Entry& e) override;
+
+    bool read(uint32_t id, EntryData& data) override;
+
+    void remove(uint32_t id) override;
+
+    std::vector<uint32_t> getIDs() override;
+
+    int open(const Entry& e) override;
+
+    /** @brief Copy the live records into a new segment and delete the old
+     *         segments.
+     */
+    void compact();
+
+    /** @brief Returns the number of bytes used by all segments */
+    uint64_t getTotalSize() const;
+
+    /** @brief Returns the number of bytes used by the live records */
+    uint64_t getLiveSize() const
+    {
+        return liveSize;
+    }
+
+    /** @brief The default segment size */
+    static constexpr size_t defaultSegmentSize = 64 * 1024;
+
+    /** @brief How long to wait after a change before compacting, so that
+     *         a burst of deletes is only compacted once. */
+    static constexpr std::chrono::seconds compactDelay{5};
+
+  protected:
+    void commit() override;
+
+  private:
+    /** @brief The kinds of records */
+    enum class RecordType : uint8_t
+    {
+        entry = 1,
+        update = 2,
+        erased = 3,
+    };
+
+    /** @brief The header in front of every record */
+    struct RecordHeader
+    {
+        /** @brief Always recordMagic */
+        uint32_t magic;
+
+        /** @brief A RecordType */
+        uint8_t type;
+
+        /** @brief Zero */
+        uint8_t reserved[3];
+
+        /** @brief The entry ID */
+        uint32_t id;
+
+        /** @brief The size of the payload after the header */
+        uint32_t size;
+
+        /** @brief The CRC32 of the header, with this field as zero, and
+         *         the payload */
+        uint32_t crc;
+    };
+
+    static_assert(sizeof(RecordHeader) == 20);
+
+    /** @brief Where a record is */
+    struct Location
+    {
+        /** @brief The segment number */
+        uint32_t segment;
+
+        /** @brief The offset of the header in the segment */
+        uint64_t offset;
+
+        /** @brief The size of the header and payload */
+        uint32_t size;
+    };
+
+    /** @brief The current records of a live entry */
+    struct Records
+    {
+        /** @brief The entry record */
+        Location entry;
+
+        /** @brief The newest update record, if any */
+        std::optional<Location> update;
+    };
+
+    /** @brief Reads the segments and migrates legacy entry files, if not
+     *         done already. */
+    void openStore();
+
+    /** @brief Applies the valid records of a segment to the index.
+     *
+     *  @param[in] segment - The segment number
+     *  @param[in] newest - If this is the newest segment, which is
+     *                      truncated at the first damaged record
+     */
+    void replay(uint32_t segment, bool newest);
+
+    /** @brief Applies a record to the index.
+     *
+     *  @param[in] type - The record type
+     *  @param[in] id - The entry ID
+     *  @param[in] location - Where the record is
+     */
+    void apply(RecordType type, uint32_t id, const Location& location);
+
+    /** @brief Moves entry files from legacyDir into the log. */
+    void migrate();
+
+    /** @brief Appends a record to the newest segment, starting a new one
+     *         if it is full.
+     *
+     *  @param[in] type - The record type
+     *  @param[in] id - The entry ID
+     *  @param[in] payload - The record payload
+     *
+     *  @return Where the record was written, or an empty optional if it
+     *          couldn't be.
+     */
+    std::optional<Location> append(RecordType type, uint32_t id,
+                                   const std::string& payload);
+
+    /** @brief Reads the payload of a record, checking its CRC.
+     *
+     *  @param[in] location - Where the record is
+     *
+     *  @return The payload, or an empty optional if it couldn't be read
+     */
+    std::optional<std::string> read(const Location& location) const;
+
+    /** @brief Reads a whole record, header included.
+     *
+     *  @param[in] location - Where the record is
+     *
+     *  @return The record, or an empty optional if it couldn't be read
+     */
+    std::optional<std::string> readRecord(const Location& location) const;
+
+    /** @brief Starts the compaction timer if enough of the store is
+     *         superseded records. */
+    void scheduleCompaction();
+
+    /** @brief Returns the path of a segment file */
+    fs::path getSegmentPath(uint32_t segment) const;
+
+    /** @brief Returns the size of an entry's live records */
+    static uint64_t getSize(const Records& records);
+
+    /** @brief The directory of the segment files */
+    const fs::path dir;
+
+    /** @brief The directory of the entry files to migrate */
+    const fs::path legacyDir;
+
+    /** @brief The size to start a new segment at */
+    const size_t segmentSize;
+
+    /** @brief If the store has been read in */
+    bool opened = false;
+
+    /** @brief The live entries' records, by entry ID */
+    std::map<uint32_t, Records> index;
+
+    /** @brief The size of every segment, by segment number */
+    std::map<uint32_t, uint64_t> segments;
+
+    /** @brief The bytes used by the live records */
+    uint64_t liveSize = 0;
+
+    /** @brief The newest segment, opened for appending */
+    int fd = -1;
+
+    /** @brief Fires to compact the store */
+    std::unique_ptr<
+        sdeventplus::utility::Timer<sdeventplus::ClockId::Monotonic>>
+        compactTimer;
+};
+
+} // namespace logging
+} // namespace phosphor
@@ -0,0 +1,112 @@
+#include "logging_settings.hpp"
+
+#include <phosphor-logging/lg2.hpp>
+
+#include <functional>
+
+namespace phosphor
+{
+namespace logging
+{
+
+bool LoggingSettings::quiesceOnHwError()
+{
+    load();
+    return quiesceOnHwErrorValue.value_or(false);
+}
+
+void LoggingSettings::load()
+{
+    using namespace sdbusplus::bus::match::rules;
+
+    // Subscribe first so that no change can be missed between the read
+    // and the subscription.
+    if (!propertiesChangedMatch)
+    {
+        propertiesChangedMatch = std::make_unique<sdbusplus::bus::match_t>(
+            bus, propertiesChanged(path, interface),
+            std::bind(std::mem_fn(&LoggingSettings::onPropertiesChanged),
+                      this, std::placeholders::_1));
+
+        interfacesAddedMatch = std::make_unique<sdbusplus::bus::match_t>(
+            bus, interfacesAdded() + argNpath(0, path),
+            std::bind(std::mem_fn(&LoggingSettings::onInterfacesAdded), this,
+                      std::placeholders::_1));
+    }
+
+    if (loaded)
+    {
+        return;
+    }
+
+    auto method = bus.new_method_call(service, path,
+                                      "org.freedesktop.DBus.Properties",
+                                      "GetAll");
+    method.append(interface);
+
+    try
+    {
+        auto reply = bus.call(method);
+        Properties properties;
+        reply.read(properties);
+        update(properties);
+        loaded = true;
+    }
+    catch (const sdbusplus::exception_t& e)
+    {
+        // Try again next time, unless a signal fills them in first.
+        lg2::error("Error reading the logging settings: {ERROR}", "ERROR", e);
+    }
+}
+
+void LoggingSettings::update(const Properties& properties)
+{
+    auto quiesce = properties.find("QuiesceOnHwError");
+    if (quiesce != properties.end())
+    {
+        quiesceOnHwErrorValue = std::get<bool>(quiesce->second);
+    }
+}
+
+void LoggingSettings::onPropertiesChanged(sdbusplus::message_t& msg)
+{
+    try
+    {
+        std::string iface;
+        Properties properties;
+        msg.read(iface, properties);
+        update(properties);
+    }
+    catch (const sdbusplus::exception_t& e)
+    {
+        lg2::error("Error reading the logging settings PropertiesChanged "
+                   "signal: {ERROR}",
+                   "ERROR", e);
+    }
+}
+
+void LoggingSettings::onInterfacesAdded(sdbusplus::message_t& msg)
+{
+    try
+    {
+        sdbusplus::message::object_path objectPath;
+        std::map<std::string, Properties> interfaces;
+        msg.read(objectPath, interfaces);
+
+        auto settings = interfaces.find(interface);
+        if (settings != interfaces.end())
+        {
+            update(settings->second);
+            loaded = true;
+        }
+    }
+    catch (const sdbusplus::exception_t& e)
+    {
+        lg2::error("Error reading the logging settings InterfacesAdded "
+                   "signal: {ERROR}",
+                   "ERROR", e);
+    }
+}
+
+} // namespace logging
+} // namespace phosphor
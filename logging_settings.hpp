@@ -0,0 +1,91 @@
+#pragma once
+
+#include <sdbusplus/bus.hpp>
+#include <sdbusplus/bus/match.hpp>
+
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <variant>
+
+namespace phosphor
+{
+namespace logging
+{
+
+/** @class LoggingSettings
+ *  @brief Keeps a copy of the xyz.openbmc_project.Logging.Settings
+ *         properties from the settings service.
+ *  @details The properties are read once, and then kept up to date from
+ *           the PropertiesChanged and InterfacesAdded signals of the
+ *           settings object, so reading them never needs a D-Bus call.
+ *           The InterfacesAdded signal covers the settings service being
+ *           restarted.
+ */
+class LoggingSettings
+{
+  public:
+    LoggingSettings() = delete;
+    LoggingSettings(const LoggingSettings&) = delete;
+    LoggingSettings& operator=(const LoggingSettings&) = delete;
+    LoggingSettings(LoggingSettings&&) = delete;
+    LoggingSettings& operator=(LoggingSettings&&) = delete;
+    ~LoggingSettings() = default;
+
+    /** @brief Constructor
+     *
+     *  Nothing is read or subscribed to until a setting is first asked for.
+     *
+     *  @param[in] bus - The bus the settings service is on.
+     */
+    explicit LoggingSettings(sdbusplus::bus_t& bus) : bus(bus) {}
+
+    /** @brief Returns the QuiesceOnHwError setting, or false if the
+     *         settings service doesn't have it.
+     */
+    bool quiesceOnHwError();
+
+    static constexpr auto service = "xyz.openbmc_project.Settings";
+    static constexpr auto path = "/xyz/openbmc_project/logging/settings";
+    static constexpr auto interface = "xyz.openbmc_project.Logging.Settings";
+
+  private:
+    using PropertyValue = std::variant<bool>;
+    using Properties = std::map<std::string, PropertyValue>;
+
+    /** @brief Subscribes to the signals and reads the properties, if not
+     *         done already.
+     */
+    void load();
+
+    /** @brief Updates the copy of the properties.
+     *
+     *  @param[in] properties - The new property values
+     */
+    void update(const Properties& properties);
+
+    /** @brief Handles the PropertiesChanged signal */
+    void onPropertiesChanged(sdbusplus::message_t& msg);
+
+    /** @brief Handles the InterfacesAdded signal */
+    void onInterfacesAdded(sdbusplus::message_t& msg);
+
+    /** @brief The bus the settings service is on */
+    sdbusplus::bus_t& bus;
+
+    /** @brief If the properties have been read */
+    bool loaded = false;
+
+    /** @brief The QuiesceOnHwError property */
+    std::optional<bool> quiesceOnHwErrorValue;
+
+    /** @brief The PropertiesChanged match */
+    std::unique_ptr<sdbusplus::bus::match_t> propertiesChangedMatch;
+
+    /** @brief The InterfacesAdded match */
+    std::unique_ptr<sdbusplus::bus::match_t> interfacesAddedMatch;
+};
+
+} // namespace logging
+} // namespace phosphor
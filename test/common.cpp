@@ -1,5 +1,6 @@
 #include "config.h"
 
 const char* ERRLOG_PERSIST_PATH = "/tmp/errors";
+const char* ERRLOG_STORE_PATH = "/tmp/store";
 const char* EXTENSION_PERSIST_DIR = "/tmp/extensions";
 const bool IS_UNIT_TEST = true;
@@ -0,0 +1,205 @@
+#include "config.h"
+
+#include "log_manager.hpp"
+
+#include <phosphor-logging/elog.hpp>
+#include <sdbusplus/bus.hpp>
+#include <sdbusplus/server/manager.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <string>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+namespace phosphor
+{
+namespace logging
+{
+namespace test
+{
+
+namespace fs = std::filesystem;
+using namespace std::chrono_literals;
+
+/** @brief A Manager whose asynchronous commits the tests finish */
+class AsyncManager : public internal::Manager
+{
+  public:
+    AsyncManager(sdbusplus::bus_t& bus, const char* objPath) :
+        Manager(bus, objPath)
+    {}
+
+    using Manager::finishCommit;
+    using Manager::queueCommit;
+};
+
+/** @brief Runs waitForEntry() on its own thread and bus connection */
+class Waiter
+{
+  public:
+    Waiter(const std::string& service, uint32_t id,
+           std::chrono::milliseconds timeout) :
+        thread([this, service, id, timeout]() {
+            auto bus = sdbusplus::bus::new_bus();
+            found = waitForEntry(bus, service, id, timeout);
+            done = true;
+        })
+    {}
+
+    ~Waiter()
+    {
+        thread.join();
+    }
+
+    std::atomic<bool> done = false;
+    bool found = false;
+
+  private:
+    std::thread thread;
+};
+
+class TestAsyncCommit : public testing::Test
+{
+  public:
+    TestAsyncCommit() :
+        bus(sdbusplus::bus::new_default()), objManager(bus, OBJ_LOGGING),
+        manager(bus, OBJ_INTERNAL)
+    {
+        fs::create_directories(ERRLOG_PERSIST_PATH);
+    }
+
+    ~TestAsyncCommit() override
+    {
+        manager.eraseAll();
+    }
+
+    uint32_t queue(const std::string& message)
+    {
+        return manager.queueCommit(0, std::string{message},
+                                   Entry::Level::Error);
+    }
+
+    /** @brief Handles bus messages for a while, like the checks that
+     *         waitForEntry() makes. */
+    void processFor(std::chrono::milliseconds time)
+    {
+        auto end = std::chrono::steady_clock::now() + time;
+        while (std::chrono::steady_clock::now() < end)
+        {
+            bus.process_discard();
+            bus.wait(std::chrono::microseconds{10ms});
+        }
+    }
+
+    void processUntil(const std::atomic<bool>& done)
+    {
+        while (!done)
+        {
+            processFor(10ms);
+        }
+    }
+
+    sdbusplus::bus_t bus;
+    sdbusplus::server::manager_t objManager;
+    AsyncManager manager;
+};
+
+// IDs are handed out when commits are queued, before their entries exist.
+TEST_F(TestAsyncCommit, testIDReservation)
+{
+    auto first = queue("first");
+    auto second = queue("second");
+    EXPECT_EQ(second, first + 1);
+    EXPECT_EQ(manager.lastEntryID(), second);
+    EXPECT_TRUE(manager.entries.empty());
+
+    // An entry created in the meantime gets the next one.
+    manager.create("third", Entry::Level::Informational, {});
+    EXPECT_EQ(manager.lastEntryID(), second + 1);
+    EXPECT_TRUE(manager.entries.contains(second + 1));
+    EXPECT_EQ(manager.entries.size(), 1);
+}
+
+TEST_F(TestAsyncCommit, testFinishCommit)
+{
+    auto first = queue("first");
+    auto second = queue("second");
+
+    // They can finish in any order.
+    manager.finishCommit(second);
+    manager.finishCommit(first);
+
+    ASSERT_EQ(manager.entries.size(), 2);
+    auto entry = manager.entries.find(first);
+    ASSERT_NE(entry, manager.entries.end());
+    EXPECT_EQ(entry->second->message(), "first");
+    EXPECT_EQ(entry->second->severity(), Entry::Level::Error);
+    EXPECT_EQ(manager.entries.at(second)->message(), "second");
+    EXPECT_EQ(manager.getRealErrSize(), 2);
+
+    // A commit only finishes once.
+    manager.finishCommit(first);
+    EXPECT_EQ(manager.entries.size(), 2);
+}
+
+TEST_F(TestAsyncCommit, testEraseAllWhilePending)
+{
+    auto first = queue("first");
+    auto second = queue("second");
+    manager.finishCommit(first);
+
+    manager.eraseAll();
+    EXPECT_TRUE(manager.entries.empty());
+
+    // The pending commit's ID isn't handed out again, and it still
+    // gets its entry.
+    EXPECT_EQ(manager.lastEntryID(), second);
+    EXPECT_EQ(queue("third"), second + 1);
+
+    manager.finishCommit(second);
+    EXPECT_TRUE(manager.entries.contains(second));
+
+    // Once nothing is pending, the IDs start over.
+    manager.finishCommit(second + 1);
+    manager.eraseAll();
+    EXPECT_EQ(manager.lastEntryID(), 0);
+}
+
+TEST_F(TestAsyncCommit, testWaitForEntry)
+{
+    auto id = queue("test error");
+    auto service = bus.get_unique_name();
+
+    {
+        Waiter waiter{service, id, 10s};
+
+        // It keeps waiting while the commit is pending.
+        processFor(200ms);
+        EXPECT_FALSE(waiter.done);
+
+        manager.finishCommit(id);
+        processUntil(waiter.done);
+        EXPECT_TRUE(waiter.found);
+    }
+
+    // Once the entry is there, it's found right away.
+    {
+        Waiter waiter{service, id, 10s};
+        processUntil(waiter.done);
+        EXPECT_TRUE(waiter.found);
+    }
+
+    // An entry that never shows up times out.
+    {
+        Waiter waiter{service, id + 1, 100ms};
+        processUntil(waiter.done);
+        EXPECT_FALSE(waiter.found);
+    }
+}
+
+} // namespace test
+} // namespace logging
+} // namespace phosphor
@@ -1,5 +1,7 @@
 #include "elog_errorwrap_test.hpp"
 
+#include <sys/stat.h>
+
 namespace phosphor
 {
 namespace logging
@@ -26,6 +28,94 @@ TEST_F(TestLogManager, logCap)
     EXPECT_EQ(ERROR_CAP, manager.getRealErrSize());
 }
 
+TEST_F(TestLogManager, logCapBatch)
+{
+    std::vector<BatchEvent> events;
+    for (size_t i = 0; i < ERROR_INFO_CAP + 5; i++)
+    {
+        events.emplace_back("FOO", Entry::Level::Informational,
+                            std::map<std::string, std::string>{
+                                {"INDEX", std::to_string(i)}});
+    }
+    events.emplace_back("BAR", Entry::Level::Error,
+                        std::map<std::string, std::string>{});
+
+    auto first = manager.lastEntryID() + 1;
+    auto ids = manager.createBatch(events);
+
+    ASSERT_EQ(events.size(), ids.size());
+    for (size_t i = 0; i < ids.size(); i++)
+    {
+        EXPECT_EQ(first + i, ids[i]);
+    }
+
+    // The oldest info entries of the batch itself are pushed out.
+    EXPECT_EQ(ERROR_INFO_CAP, manager.getInfoErrSize());
+    EXPECT_EQ(1, manager.getRealErrSize());
+    EXPECT_FALSE(manager.entries.contains(ids.front()));
+    EXPECT_TRUE(manager.entries.contains(ids[ids.size() - 2]));
+    EXPECT_TRUE(manager.entries.contains(ids.back()));
+
+    // The batch is on disk without waiting for the event loop.
+    EXPECT_TRUE(fs::exists(getEntrySerializePath(ids.back())));
+    EXPECT_FALSE(fs::exists(getEntrySerializePath(ids.front())));
+
+    EXPECT_TRUE(manager.createBatch({}).empty());
+}
+
+TEST_F(TestLogManager, deferredFlush)
+{
+    // The entry is written from the event loop, which isn't running, so
+    // nothing is on disk until the flush.
+    auto id = manager.commitWithLvl(0, "FOO", 3);
+    auto path = getEntrySerializePath(id);
+
+    manager.entries.at(id)->eventId("BAR");
+    manager.entries.at(id)->resolution("BAZ");
+    EXPECT_FALSE(fs::exists(path));
+
+    manager.flushEntry(id);
+    ASSERT_TRUE(fs::exists(path));
+
+    // Each write replaces the file, so the same inode after another flush
+    // means the creation and both changes were one write.
+    struct stat written;
+    ASSERT_EQ(stat(path.c_str(), &written), 0);
+    manager.flushEntry(id);
+    struct stat flushed;
+    ASSERT_EQ(stat(path.c_str(), &flushed), 0);
+    EXPECT_EQ(written.st_ino, flushed.st_ino);
+
+    auto entry = std::make_unique<Entry>(bus, std::string(OBJ_ENTRY) + "/x",
+                                         id, manager);
+    ASSERT_TRUE(deserialize(path, *entry));
+    EXPECT_EQ(entry->eventId(), "BAR");
+    EXPECT_EQ(entry->resolution(), "BAZ");
+
+    manager.erase(id);
+    EXPECT_FALSE(fs::exists(path));
+}
+
+TEST_F(TestLogManager, eraseAll)
+{
+    std::vector<uint32_t> ids;
+    for (size_t i = 0; i < 10; i++)
+    {
+        ids.push_back(manager.commitWithLvl(i, "FOO", (i % 2) ? 6 : 0));
+    }
+    manager.flushEntries();
+
+    manager.eraseAll();
+
+    EXPECT_TRUE(manager.entries.empty());
+    EXPECT_EQ(0, manager.getRealErrSize());
+    EXPECT_EQ(0, manager.getInfoErrSize());
+    for (auto id : ids)
+    {
+        EXPECT_FALSE(fs::exists(getEntrySerializePath(id)));
+    }
+}
+
 } // namespace internal
 } // namespace logging
 } // namespace phosphor
@@ -27,6 +27,8 @@ void deleteLog1(uint32_t /*id*/) {}
 
 void deleteLog2(uint32_t /*id*/) {}
 
+void deleteLogs1(const std::vector<uint32_t>& /*ids*/) {}
+
 void deleteProhibited1(uint32_t /*id*/, bool& prohibited)
 {
     prohibited = true;
@@ -46,6 +48,7 @@ REGISTER_EXTENSION_FUNCTION(deleteProhibited1)
 REGISTER_EXTENSION_FUNCTION(deleteProhibited2)
 REGISTER_EXTENSION_FUNCTION(deleteLog1)
 REGISTER_EXTENSION_FUNCTION(deleteLog2)
+REGISTER_EXTENSION_FUNCTION(deleteLogs1)
 
 TEST(ExtensionsTest, FunctionCallTest)
 {
@@ -74,6 +77,12 @@ TEST(ExtensionsTest, FunctionCallTest)
         d(5);
     }
 
+    EXPECT_EQ(Extensions::getDeleteBatchFunctions().size(), 1);
+    for (auto& d : Extensions::getDeleteBatchFunctions())
+    {
+        d({5, 6});
+    }
+
     EXPECT_EQ(Extensions::getDeleteProhibitedFunctions().size(), 2);
     for (auto& p : Extensions::getDeleteProhibitedFunctions())
     {
@@ -0,0 +1,148 @@
+#include "journal_sync.hpp"
+
+#include <sdbusplus/bus.hpp>
+#include <sdbusplus/test/sdbus_mock.hpp>
+#include <sdeventplus/event.hpp>
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace phosphor
+{
+namespace logging
+{
+namespace test
+{
+
+namespace fs = std::filesystem;
+using namespace std::chrono_literals;
+
+/** @brief A JournalSync that plays journald itself, writing the synced
+ *         file into a temporary directory when it is signaled. */
+class FakeJournalSync : public JournalSync
+{
+  public:
+    FakeJournalSync(sdbusplus::bus_t& bus, const fs::path& runPath) :
+        JournalSync(bus, 10ms, runPath), runPath(runPath)
+    {}
+
+    /** @brief How many times journald was asked to sync */
+    size_t flushes = 0;
+
+  protected:
+    bool signalJournald() override
+    {
+        flushes++;
+
+        // journald renames the file into place, which is what is watched.
+        {
+            std::ofstream file{runPath / "synced.tmp"};
+            file << now();
+        }
+        fs::rename(runPath / "synced.tmp", runPath / "synced");
+        return true;
+    }
+
+  private:
+    fs::path runPath;
+};
+
+class TestJournalSync : public testing::Test
+{
+  public:
+    TestJournalSync()
+    {
+        char templ[] = "/tmp/journalsynctestXXXXXX";
+        dir = mkdtemp(templ);
+    }
+
+    ~TestJournalSync() override
+    {
+        fs::remove_all(dir);
+    }
+
+    /** @brief Runs the event loop until done is set. */
+    void runUntil(const bool& done)
+    {
+        while (!done)
+        {
+            event.run(std::nullopt);
+        }
+    }
+
+    sdbusplus::SdBusMock sdbusMock;
+    sdbusplus::bus_t mockedBus = sdbusplus::get_mocked_new(&sdbusMock);
+    sdeventplus::Event event = sdeventplus::Event::get_default();
+    fs::path dir;
+};
+
+// Requests made within one window get one flush between them.
+TEST_F(TestJournalSync, testRequestsCoalesce)
+{
+    FakeJournalSync journalSync{mockedBus, dir};
+    constexpr size_t count = 20;
+
+    std::vector<size_t> order;
+    bool done = false;
+    for (size_t i = 0; i < count; i++)
+    {
+        journalSync.request([&order, &done, i]() {
+            order.push_back(i);
+            done = (order.size() == count);
+        });
+    }
+
+    EXPECT_EQ(journalSync.flushes, 0);
+    runUntil(done);
+
+    EXPECT_EQ(journalSync.flushes, 1);
+    ASSERT_EQ(order.size(), count);
+    for (size_t i = 0; i < count; i++)
+    {
+        EXPECT_EQ(order[i], i);
+    }
+
+    // A request after that one was synced needs its own flush.
+    done = false;
+    journalSync.request([&done]() { done = true; });
+    runUntil(done);
+    EXPECT_EQ(journalSync.flushes, 2);
+}
+
+// Blocking syncs share one flush within coalesce() and within the
+// callback of a request.
+TEST_F(TestJournalSync, testSyncCoalesces)
+{
+    FakeJournalSync journalSync{mockedBus, dir};
+
+    journalSync.sync();
+    journalSync.sync();
+    EXPECT_EQ(journalSync.flushes, 2);
+
+    journalSync.coalesce([&journalSync]() {
+        journalSync.sync();
+        journalSync.coalesce([&journalSync]() { journalSync.sync(); });
+        journalSync.sync();
+    });
+    EXPECT_EQ(journalSync.flushes, 3);
+
+    bool done = false;
+    journalSync.request([&journalSync, &done]() {
+        journalSync.sync();
+        done = true;
+    });
+    runUntil(done);
+    EXPECT_EQ(journalSync.flushes, 4);
+
+    // Outside of them, every sync flushes again.
+    journalSync.sync();
+    EXPECT_EQ(journalSync.flushes, 5);
+}
+
+} // namespace test
+} // namespace logging
+} // namespace phosphor
@@ -0,0 +1,82 @@
+#include <phosphor-logging/lg2.hpp>
+
+#include <iterator>
+#include <string>
+
+#include <gtest/gtest.h>
+
+namespace phosphor
+{
+namespace logging
+{
+namespace test
+{
+
+using lg2::details::message_str;
+using namespace std::string_literals;
+
+struct Sensor
+{
+    char name[16];
+};
+
+// A string literal is parsed at compile time.
+TEST(TestMessage, testLiteral)
+{
+    constexpr message_str msg{"Sensor {NAME} read {VALUE}"};
+    static_assert(msg.constant);
+    static_assert(msg.parsed);
+    static_assert(msg.count == 2);
+    static_assert(msg.placeholders[0].start == 7);
+    static_assert(msg.placeholders[0].size == 6);
+
+    lg2::info("Sensor {NAME} read {VALUE}", "NAME", "test"s, "VALUE", 1);
+}
+
+// So is a constexpr array.
+TEST(TestMessage, testConstexprArray)
+{
+    static constexpr char text[] = "Sensor {NAME} failed";
+    constexpr message_str msg{text};
+    static_assert(msg.constant);
+    static_assert(msg.count == 1);
+
+    lg2::info(text, "NAME", "test"s);
+}
+
+// Arrays which aren't constant are passed as pointers, and searched at
+// runtime.
+TEST(TestMessage, testLocalArray)
+{
+    const char text[] = "Sensor {NAME} failed";
+    message_str msg{std::data(text)};
+    EXPECT_FALSE(msg.constant);
+    EXPECT_FALSE(msg.parsed);
+    EXPECT_EQ(msg.value, text);
+
+    lg2::info(std::data(text), "NAME", "test"s);
+}
+
+TEST(TestMessage, testMemberArray)
+{
+    const Sensor sensor{"Sensor failed"};
+    message_str msg{std::data(sensor.name)};
+    EXPECT_FALSE(msg.constant);
+    EXPECT_EQ(msg.value, "Sensor failed");
+
+    lg2::info(std::data(sensor.name));
+}
+
+TEST(TestMessage, testPointer)
+{
+    std::string text{"Sensor {NAME} failed"};
+    message_str msg{text.c_str()};
+    EXPECT_FALSE(msg.constant);
+    EXPECT_EQ(msg.value, text);
+
+    lg2::info(text.c_str(), "NAME", "test"s);
+}
+
+} // namespace test
+} // namespace logging
+} // namespace phosphor
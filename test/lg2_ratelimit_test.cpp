@@ -0,0 +1,115 @@
+#include <phosphor-logging/lg2.hpp>
+
+#include <chrono>
+#include <source_location>
+
+#include <gtest/gtest.h>
+
+namespace phosphor
+{
+namespace logging
+{
+namespace test
+{
+
+using namespace std::chrono_literals;
+
+class TestRateLimit : public testing::Test
+{
+  public:
+    TestRateLimit()
+    {
+        lg2::set_threshold(lg2::level::debug);
+    }
+
+    /** @brief Asks to log an error at a time after the start. */
+    bool allow(std::chrono::nanoseconds after)
+    {
+        return limit.allow<lg2::level::error>(std::source_location::current(),
+                                              start + after);
+    }
+
+    // Four messages a second, one every 250ms.
+    lg2::ratelimit limit{4, 1s};
+    std::chrono::nanoseconds start = 100s;
+};
+
+// A full bucket lets a burst through, then suppresses the rest.
+TEST_F(TestRateLimit, testBurst)
+{
+    for (int i = 0; i < 4; i++)
+    {
+        EXPECT_TRUE(allow(0ms));
+    }
+    EXPECT_EQ(limit.suppressed_count(), 0);
+
+    EXPECT_FALSE(allow(0ms));
+    EXPECT_FALSE(allow(100ms));
+    EXPECT_EQ(limit.suppressed_count(), 2);
+}
+
+// The bucket refills one message per interval, up to the burst.
+TEST_F(TestRateLimit, testRefill)
+{
+    for (int i = 0; i < 4; i++)
+    {
+        EXPECT_TRUE(allow(0ms));
+    }
+    EXPECT_FALSE(allow(249ms));
+
+    EXPECT_TRUE(allow(250ms));
+    EXPECT_FALSE(allow(250ms));
+
+    EXPECT_TRUE(allow(500ms));
+    EXPECT_TRUE(allow(750ms));
+    EXPECT_FALSE(allow(750ms));
+
+    // After a long quiet time it only holds a burst.
+    for (int i = 0; i < 4; i++)
+    {
+        EXPECT_TRUE(allow(10s));
+    }
+    EXPECT_FALSE(allow(10s));
+}
+
+// The suppressed count is reset when a message is allowed again.
+TEST_F(TestRateLimit, testSuppressedCount)
+{
+    for (int i = 0; i < 4; i++)
+    {
+        EXPECT_TRUE(allow(0ms));
+    }
+    for (int i = 0; i < 10; i++)
+    {
+        EXPECT_FALSE(allow(10ms));
+    }
+    EXPECT_EQ(limit.suppressed_count(), 10);
+
+    EXPECT_TRUE(allow(250ms));
+    EXPECT_EQ(limit.suppressed_count(), 0);
+
+    EXPECT_FALSE(allow(250ms));
+    EXPECT_EQ(limit.suppressed_count(), 1);
+}
+
+// Messages below the threshold don't use up the bucket.
+TEST_F(TestRateLimit, testThreshold)
+{
+    lg2::set_threshold(lg2::level::critical);
+    for (int i = 0; i < 10; i++)
+    {
+        EXPECT_FALSE(allow(0ms));
+    }
+    EXPECT_EQ(limit.suppressed_count(), 0);
+
+    lg2::set_threshold(lg2::level::debug);
+    for (int i = 0; i < 4; i++)
+    {
+        EXPECT_TRUE(allow(0ms));
+    }
+    EXPECT_FALSE(allow(0ms));
+}
+
+} // namespace test
+} // namespace logging
+} // namespace phosphor
@@ -0,0 +1,272 @@
+#include "config.h"
+
+#include "elog_entry.hpp"
+#include "elog_serialize.hpp"
+#include "log_manager.hpp"
+#include "log_store.hpp"
+
+#include <stdlib.h>
+
+#include <sdbusplus/bus.hpp>
+#include <sdbusplus/test/sdbus_mock.hpp>
+
+#include <filesystem>
+#include <fstream>
+
+#include <gtest/gtest.h>
+
+namespace phosphor
+{
+namespace logging
+{
+namespace test
+{
+
+namespace fs = std::filesystem;
+
+char tmplt[] = "/tmp/log_store_test.XXXXXX";
+sdbusplus::SdBusMock sdbusMock;
+sdbusplus::bus_t bus = sdbusplus::get_mocked_new(&sdbusMock);
+phosphor::logging::internal::Manager manager(bus, OBJ_INTERNAL);
+
+class TestLogStore : public testing::Test
+{
+  public:
+    TestLogStore() :
+        dir(fs::path(mkdtemp(tmplt))), storeDir(dir / "store"),
+        legacyDir(dir / "errors")
+    {
+        fs::create_directories(legacyDir);
+    }
+
+    ~TestLogStore()
+    {
+        fs::remove_all(dir);
+    }
+
+    std::unique_ptr<Entry> makeEntry(uint32_t id, const std::string& message)
+    {
+        return std::make_unique<Entry>(
+            bus, std::string(OBJ_ENTRY) + '/' + std::to_string(id), id, 100,
+            Entry::Level::Error, std::string{message},
+            std::vector<std::string>{"KEY=VALUE"}, AssociationList{},
+            "level42", getEntrySerializePath(id, legacyDir), manager);
+    }
+
+    fs::path dir;
+    fs::path storeDir;
+    fs::path legacyDir;
+};
+
+TEST_F(TestLogStore, testSaveAndLoad)
+{
+    {
+        LogStore store{storeDir, legacyDir};
+        store.save(*makeEntry(1, "one"));
+        store.save(*makeEntry(2, "two"));
+    }
+
+    LogStore store{storeDir, legacyDir};
+    EXPECT_EQ(store.getIDs(), (std::vector<uint32_t>{1, 2}));
+
+    EntryData data;
+    ASSERT_TRUE(store.read(2, data));
+    EXPECT_EQ(data.id, 2);
+    EXPECT_EQ(data.message, "two");
+    EXPECT_EQ(data.severity, Entry::Level::Error);
+    EXPECT_EQ(data.additionalData, std::vector<std::string>{"KEY=VALUE"});
+    EXPECT_EQ(data.fwVersion, "level42");
+
+    // The entry file format is handed out for GetEntry
+    auto e = makeEntry(2, "two");
+    int fd = store.open(*e);
+    ASSERT_GE(fd, 0);
+    std::string fileData(4096, '\0');
+    fileData.resize(read(fd, fileData.data(), fileData.size()));
+    close(fd);
+    EXPECT_EQ(fileData, serializeToString(*e));
+}
+
+TEST_F(TestLogStore, testUpdates)
+{
+    {
+        LogStore store{storeDir, legacyDir};
+        auto e = makeEntry(1, "one");
+        store.save(*e);
+
+        e->severity(Entry::Level::Warning, true);
+        e->sdbusplus::server::xyz::openbmc_project::logging::Entry::resolution(
+            "replace it", true);
+        store.save(*e);
+
+        // Only the changed properties are written the second time.
+        EXPECT_LT(store.getTotalSize(), 2 * serializeToString(*e).size());
+    }
+
+    LogStore store{storeDir, legacyDir};
+    EntryData data;
+    ASSERT_TRUE(store.read(1, data));
+    EXPECT_EQ(data.message, "one");
+    EXPECT_EQ(data.severity, Entry::Level::Warning);
+    EXPECT_EQ(data.resolution, "replace it");
+}
+
+TEST_F(TestLogStore, testRemove)
+{
+    {
+        LogStore store{storeDir, legacyDir};
+        store.save(*makeEntry(1, "one"));
+        store.save(*makeEntry(2, "two"));
+        store.remove(1);
+        EXPECT_EQ(store.getIDs(), std::vector<uint32_t>{2});
+    }
+
+    LogStore store{storeDir, legacyDir};
+    EXPECT_EQ(store.getIDs(), std::vector<uint32_t>{2});
+
+    EntryData data;
+    EXPECT_FALSE(store.read(1, data));
+}
+
+TEST_F(TestLogStore, testTornWrite)
+{
+    {
+        LogStore store{storeDir, legacyDir};
+        store.save(*makeEntry(1, "one"));
+    }
+
+    // Half of a record at the end of the segment
+    auto segment = fs::directory_iterator(storeDir)->path();
+    auto size = fs::file_size(segment);
+    {
+        std::ofstream file{segment, std::ios::app | std::ios::binary};
+        file << "ELOG half a record";
+    }
+
+    {
+        LogStore store{storeDir, legacyDir};
+        EXPECT_EQ(store.getIDs(), std::vector<uint32_t>{1});
+        EXPECT_EQ(fs::file_size(segment), size);
+        store.save(*makeEntry(2, "two"));
+    }
+
+    LogStore store{storeDir, legacyDir};
+    EXPECT_EQ(store.getIDs(), (std::vector<uint32_t>{1, 2}));
+    EntryData data;
+    EXPECT_TRUE(store.read(2, data));
+}
+
+TEST_F(TestLogStore, testBadChecksum)
+{
+    {
+        LogStore store{storeDir, legacyDir};
+        store.save(*makeEntry(1, "one"));
+        store.save(*makeEntry(2, "two"));
+    }
+
+    // Flip a byte in the payload of the first record
+    auto segment = fs::directory_iterator(storeDir)->path();
+    {
+        std::fstream file{segment,
+                          std::ios::in | std::ios::out | std::ios::binary};
+        file.seekp(30);
+        file.put('X');
+    }
+
+    LogStore store{storeDir, legacyDir};
+    EXPECT_EQ(store.getIDs(), std::vector<uint32_t>{2});
+}
+
+TEST_F(TestLogStore, testCompaction)
+{
+    LogStore store{storeDir, legacyDir, 1024};
+
+    for (uint32_t id = 1; id <= 50; id++)
+    {
+        store.save(*makeEntry(id, "message " + std::to_string(id)));
+    }
+    for (uint32_t id = 1; id < 50; id++)
+    {
+        store.remove(id);
+    }
+
+    auto before = store.getTotalSize();
+    store.compact();
+
+    EXPECT_LT(store.getTotalSize(), before);
+    EXPECT_EQ(store.getTotalSize(), store.getLiveSize());
+    EXPECT_EQ(std::distance(fs::directory_iterator(storeDir),
+                            fs::directory_iterator()),
+              1);
+
+    LogStore reopened{storeDir, legacyDir, 1024};
+    EXPECT_EQ(reopened.getIDs(), std::vector<uint32_t>{50});
+    EntryData data;
+    ASSERT_TRUE(reopened.read(50, data));
+    EXPECT_EQ(data.message, "message 50");
+}
+
+TEST_F(TestLogStore, testMigration)
+{
+    serialize(*makeEntry(7, "seven"), legacyDir);
+    serialize(*makeEntry(8, "eight"), legacyDir);
+
+    LogStore store{storeDir, legacyDir};
+    EXPECT_EQ(store.getIDs(), (std::vector<uint32_t>{7, 8}));
+    EXPECT_TRUE(fs::is_empty(legacyDir));
+
+    EntryData data;
+    ASSERT_TRUE(store.read(7, data));
+    EXPECT_EQ(data.message, "seven");
+}
+
+TEST_F(TestLogStore, testGroupCommit)
+{
+    LogStore store{storeDir, legacyDir};
+    store.save(*makeEntry(1, "one"));
+    store.save(*makeEntry(2, "two"));
+    store.remove(1);
+    store.sync();
+    store.sync();
+
+    const auto& stats = store.getCommitStats();
+    EXPECT_EQ(stats.batches, 1);
+    EXPECT_EQ(stats.writes, 3);
+    EXPECT_EQ(stats.maxBatchSize, 3);
+    EXPECT_EQ(stats.batchSizes[1], 1);
+}
+
+TEST_F(TestLogStore, testFileStoreCommit)
+{
+    FileStore store{legacyDir};
+    store.save(*makeEntry(1, "one"));
+    store.save(*makeEntry(2, "two"));
+
+    // Nothing replaces the entry files until the commit.
+    EXPECT_TRUE(fs::exists(getEntryTempPath(1, legacyDir)));
+    EXPECT_FALSE(fs::exists(getEntrySerializePath(1, legacyDir)));
+
+    store.remove(2);
+    EXPECT_FALSE(fs::exists(getEntryTempPath(2, legacyDir)));
+
+    store.sync();
+    EXPECT_FALSE(fs::exists(getEntryTempPath(1, legacyDir)));
+    EXPECT_TRUE(fs::exists(getEntrySerializePath(1, legacyDir)));
+    EXPECT_FALSE(fs::exists(getEntrySerializePath(2, legacyDir)));
+    EXPECT_EQ(store.getCommitStats().batches, 1);
+
+    EntryData data;
+    ASSERT_TRUE(store.read(1, data));
+    EXPECT_EQ(data.message, "one");
+
+    // A write torn by a power loss is thrown away at startup.
+    std::ofstream{getEntryTempPath(1, legacyDir)} << "torn";
+    EXPECT_EQ(store.getIDs(), std::vector<uint32_t>{1});
+    EXPECT_FALSE(fs::exists(getEntryTempPath(1, legacyDir)));
+    ASSERT_TRUE(store.read(1, data));
+    EXPECT_EQ(data.message, "one");
+}
+
+} // namespace test
+} // namespace logging
+} // namespace phosphor
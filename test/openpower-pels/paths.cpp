@@ -74,5 +74,11 @@ size_t getMaxNumPELs()
     return 100;
 }
 
+size_t getPELRestoreThreads()
+{
+    // More than one, so the tests use the worker threads.
+    return 2;
+}
+
 } // namespace pels
 } // namespace openpower
@@ -20,6 +20,7 @@
 #include <ext/stdio_filebuf.h>
 
 #include <filesystem>
+#include <fstream>
 
 #include <gtest/gtest.h>
 
@@ -116,6 +117,57 @@ TEST_F(RepositoryTest, RemoveTest)
     EXPECT_FALSE(repo.remove(id));
 }
 
+TEST_F(RepositoryTest, RemoveBatchTest)
+{
+    using pelID = Repository::LogID::Pel;
+    using obmcID = Repository::LogID::Obmc;
+
+    {
+        Repository repo{repoPath};
+        for (uint32_t i = 1; i <= 3; i++)
+        {
+            auto data = pelFactory(i, 'O', 0x20, 0x8800, 500);
+            auto pel = std::make_unique<PEL>(data, i + 100);
+            repo.add(pel);
+        }
+
+        auto bmcSize = repo.getSizeStats().bmc;
+
+        std::vector<uint32_t> deleted;
+        repo.subscribeToDeletes(
+            "test", [&deleted](uint32_t id) { deleted.push_back(id); });
+
+        // One is missing, so only two are removed
+        auto removed = repo.removeBatch({Repository::LogID{obmcID{101}},
+                                         Repository::LogID{pelID{3}},
+                                         Repository::LogID{pelID{4}}});
+        ASSERT_EQ(removed.size(), 2);
+        EXPECT_EQ(removed[0], (Repository::LogID{pelID{1}, obmcID{101}}));
+        EXPECT_EQ(removed[1], (Repository::LogID{pelID{3}, obmcID{103}}));
+        EXPECT_EQ(deleted, (std::vector<uint32_t>{1, 3}));
+
+        EXPECT_FALSE(repo.hasPEL(Repository::LogID{pelID{1}}));
+        EXPECT_TRUE(repo.hasPEL(Repository::LogID{pelID{2}}));
+        EXPECT_FALSE(repo.hasPEL(Repository::LogID{pelID{3}}));
+
+        // The PELs are the same size, so one third is left
+        EXPECT_EQ(repo.getSizeStats().bmc * 3, bmcSize);
+
+        auto archived = std::distance(
+            fs::directory_iterator(repoPath / "logs" / "archive"),
+            fs::directory_iterator());
+        EXPECT_EQ(archived, 2);
+    }
+
+    // The index agrees with the files when the repository is reopened
+    {
+        Repository repo{repoPath};
+        EXPECT_EQ(repo.getAttributesMap().size(), 1);
+        EXPECT_TRUE(repo.hasPEL(Repository::LogID{pelID{2}}));
+        EXPECT_FALSE(repo.hasPEL(Repository::LogID{obmcID{101}}));
+    }
+}
+
 TEST_F(RepositoryTest, RestoreTest)
 {
     using pelID = Repository::LogID::Pel;
@@ -186,6 +238,76 @@ TEST_F(RepositoryTest, RestoreTest)
     }
 }
 
+TEST_F(RepositoryTest, RestoreFromIndexTest)
+{
+    using pelID = Repository::LogID::Pel;
+
+    fs::path file;
+
+    {
+        Repository repo{repoPath};
+        for (uint32_t i = 1; i <= 3; i++)
+        {
+            auto data = pelFactory(i, 'O', 0x20, 0x8800, 500);
+            auto pel = std::make_unique<PEL>(data);
+            repo.add(pel);
+        }
+
+        repo.setPELHostTransState(1, TransmissionState::acked);
+        repo.setPELHMCTransState(2, TransmissionState::acked);
+        EXPECT_TRUE(repo.remove(Repository::LogID{pelID{3}}));
+
+        file = repo.getPELAttributes(Repository::LogID{pelID{2}})
+                   ->get()
+                   .path;
+    }
+
+    EXPECT_TRUE(fs::exists(repoPath / "attributes_index"));
+
+    {
+        // The attributes come back, including the changed states
+        Repository repo{repoPath};
+        EXPECT_EQ(repo.getAttributesMap().size(), 2);
+        EXPECT_FALSE(repo.hasPEL(Repository::LogID{pelID{3}}));
+
+        auto a = repo.getPELAttributes(Repository::LogID{pelID{1}});
+        ASSERT_TRUE(a);
+        EXPECT_EQ(a->get().hostState, TransmissionState::acked);
+        EXPECT_EQ(a->get().hmcState, TransmissionState::newPEL);
+        EXPECT_EQ(a->get().severity, 0x20);
+        EXPECT_EQ(a->get().actionFlags.to_ulong(), 0x8800);
+
+        a = repo.getPELAttributes(Repository::LogID{pelID{2}});
+        ASSERT_TRUE(a);
+        EXPECT_EQ(a->get().hmcState, TransmissionState::acked);
+        EXPECT_EQ(a->get().path, file);
+    }
+
+    // Replace a PEL file behind the repository's back, which
+    // the index must not hide.
+    {
+        auto data = pelFactory(2, 'O', 0x40, 0x8800, 600);
+        std::ofstream pelFile{file, std::ios::binary};
+        pelFile.write(reinterpret_cast<const char*>(data.data()), data.size());
+    }
+
+    {
+        Repository repo{repoPath};
+        auto a = repo.getPELAttributes(Repository::LogID{pelID{2}});
+        ASSERT_TRUE(a);
+        EXPECT_EQ(a->get().severity, 0x40);
+        EXPECT_EQ(a->get().hmcState, TransmissionState::newPEL);
+    }
+
+    // A missing index just means reading all the PELs again
+    fs::remove(repoPath / "attributes_index");
+    {
+        Repository repo{repoPath};
+        EXPECT_EQ(repo.getAttributesMap().size(), 2);
+        EXPECT_TRUE(fs::exists(repoPath / "attributes_index"));
+    }
+}
+
 TEST_F(RepositoryTest, TestGetPELData)
 {
     using ID = Repository::LogID;
@@ -419,6 +541,37 @@ TEST_F(RepositoryTest, TestSetHMCState)
     }
 }
 
+TEST_F(RepositoryTest, TestSetStateBadFile)
+{
+    auto data = pelDataFactory(TestPELType::pelSimple);
+    auto pel = std::make_unique<PEL>(data);
+    using ID = Repository::LogID;
+    ID id{ID::Pel(pel->id())};
+
+    Repository repo{repoPath};
+    repo.add(pel);
+
+    // Clobber the private header, so the user header can't be found
+    auto path = repo.getPELAttributes(id)->get().path;
+    {
+        std::vector<uint8_t> garbage(100, 0xFF);
+        std::ofstream file{path, std::ios::binary};
+        file.write(reinterpret_cast<const char*>(garbage.data()),
+                   garbage.size());
+    }
+
+    repo.setPELHostTransState(pel->id(), TransmissionState::acked);
+    repo.setPELHMCTransState(pel->id(), TransmissionState::acked);
+
+    auto a = repo.getPELAttributes(id);
+    EXPECT_EQ((*a).get().hostState, TransmissionState::newPEL);
+    EXPECT_EQ((*a).get().hmcState, TransmissionState::newPEL);
+
+    // The file wasn't written
+    auto fileData = readPELFile(path);
+    EXPECT_EQ(*fileData, std::vector<uint8_t>(100, 0xFF));
+}
+
 TEST_F(RepositoryTest, TestGetPELFD)
 {
     Repository repo{repoPath};
@@ -1016,6 +1169,48 @@ TEST_F(RepositoryTest, GetLogIDNotFoundTC)
     ASSERT_TRUE(!logID.has_value());
 }
 
+TEST_F(RepositoryTest, LookupAfterRemoveTC)
+{
+    using pelID = Repository::LogID::Pel;
+    using obmcID = Repository::LogID::Obmc;
+
+    Repository repo{repoPath};
+
+    // The OpenBMC log ID is the PEL ID + 500, except for the last
+    // two PELs which share one.
+    for (uint32_t i = 1; i <= 5; i++)
+    {
+        auto data = pelFactory(i, 'O', 0x20, 0x8800, 500);
+        auto pel = (i < 4) ? std::make_unique<PEL>(data)
+                           : std::make_unique<PEL>(data, 1000);
+        repo.add(pel);
+    }
+
+    EXPECT_TRUE(repo.remove(Repository::LogID{pelID{2}}));
+    EXPECT_TRUE(repo.remove(Repository::LogID{obmcID{503}}));
+
+    EXPECT_TRUE(repo.hasPEL(Repository::LogID{pelID{1}}));
+    EXPECT_TRUE(repo.hasPEL(Repository::LogID{obmcID{501}}));
+    EXPECT_FALSE(repo.hasPEL(Repository::LogID{pelID{2}}));
+    EXPECT_FALSE(repo.hasPEL(Repository::LogID{obmcID{502}}));
+    EXPECT_FALSE(repo.hasPEL(Repository::LogID{pelID{3}}));
+    EXPECT_FALSE(repo.hasPEL(Repository::LogID{obmcID{503}}));
+
+    // A shared OpenBMC log ID finds the lowest PEL ID first.
+    auto logID = repo.getLogID(Repository::LogID{obmcID{1000}});
+    ASSERT_TRUE(logID);
+    EXPECT_EQ(logID->pelID.id, 4);
+
+    EXPECT_TRUE(repo.remove(Repository::LogID{obmcID{1000}}));
+    logID = repo.getLogID(Repository::LogID{obmcID{1000}});
+    ASSERT_TRUE(logID);
+    EXPECT_EQ(logID->pelID.id, 5);
+
+    EXPECT_TRUE(repo.remove(Repository::LogID{obmcID{1000}}));
+    EXPECT_FALSE(repo.hasPEL(Repository::LogID{obmcID{1000}}));
+    EXPECT_FALSE(repo.hasPEL(Repository::LogID{pelID{5}}));
+}
+
 // Test that OpenBMC log Id with hardware isolation entry is not removed.
 TEST_F(RepositoryTest, TestPruneWithIdHwIsoEntry)
 {
@@ -0,0 +1,385 @@
+// Decode the binary trace files written by lg2 when `LG2_TRACE` is set.
+
+#include "lg2_format.hpp"
+#include "lg2_trace.hpp"
+
+#include <getopt.h>
+
+#include <phosphor-logging/lg2/flags.hpp>
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace lg2;
+using namespace lg2::details;
+
+const char* usage = "Usage: lg2-trace-decode [OPTION] FILE     \n\n\
+Options:                                                     \n\
+-h, --help                      Display this usage text.     \n\
+-e, --export                    Write journal export format. \n\
+-f, --format <string>           Format of each message, as   \n\
+                                for LG2_FORMAT [\"<%l> %m\"].\n";
+
+/** A trace file read into memory. */
+class trace_reader
+{
+  public:
+    explicit trace_reader(std::vector<char>&& data) : data(std::move(data)) {}
+
+    /** Check the header and that the tables lie within the file. */
+    bool valid() const
+    {
+        if (data.size() < sizeof(trace::file_header))
+        {
+            return false;
+        }
+
+        auto h = header();
+        return h.magic == trace::magic && h.version == trace::version &&
+               h.sites_offset + h.sites_size <= data.size() &&
+               h.sites_used <= h.sites_size &&
+               h.ring_offset + h.ring_size <= data.size() &&
+               h.head <= h.tail && h.tail - h.head <= h.ring_size;
+    }
+
+    trace::file_header header() const
+    {
+        trace::file_header h;
+        memcpy(&h, data.data(), sizeof(h));
+        return h;
+    }
+
+    /** Call f with each record, oldest first, and its call site.
+     *
+     *  @return false if the file is corrupt.
+     */
+    template <typename F>
+    bool for_each(F&& f) const
+    {
+        auto h = header();
+        std::string_view ring{data.data() + h.ring_offset, h.ring_size};
+        std::string_view sites{data.data() + h.sites_offset, h.sites_used};
+
+        for (auto pos = h.head; pos != h.tail;)
+        {
+            auto offset = pos % h.ring_size;
+            auto left = h.ring_size - offset;
+            if (left < sizeof(trace::record_header))
+            {
+                pos += left;
+                continue;
+            }
+
+            trace::record_header rh;
+            memcpy(&rh, ring.data() + offset, sizeof(rh));
+            if (rh.size < sizeof(rh) || rh.size > left ||
+                rh.size > h.tail - pos)
+            {
+                return false;
+            }
+            pos += rh.size;
+
+            if (rh.site == trace::padding_site)
+            {
+                continue;
+            }
+
+            if (rh.site >= sites.size())
+            {
+                return false;
+            }
+
+            std::string_view record = ring.substr(offset, rh.size);
+            record.remove_prefix(sizeof(rh));
+            if (!f(rh, sites.substr(rh.site), record))
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+  private:
+    std::vector<char> data;
+};
+
+/** Take a value of a trivial type off the front of a string. */
+template <typename T>
+static std::optional<T> take(std::string_view& s)
+{
+    if (s.size() < sizeof(T))
+    {
+        return std::nullopt;
+    }
+
+    T v;
+    memcpy(&v, s.data(), sizeof(v));
+    s.remove_prefix(sizeof(v));
+    return v;
+}
+
+/** Take a uint32_t length and that many characters off a string. */
+static std::optional<std::string_view> take_string(std::string_view& s)
+{
+    auto size = take<uint32_t>(s);
+    if (!size || *size > s.size())
+    {
+        return std::nullopt;
+    }
+
+    auto v = s.substr(0, *size);
+    s.remove_prefix(*size);
+    return v;
+}
+
+/** A call site read from the site table. */
+struct call_site
+{
+    level l;
+    uint32_t line;
+    std::string_view file;
+    std::string_view function;
+    std::string message;
+    std::vector<std::string_view> headers;
+};
+
+static std::optional<call_site> read_site(std::string_view s)
+{
+    auto sh = take<trace::site_header>(s);
+    if (!sh || sh->size < sizeof(*sh) ||
+        sh->size - sizeof(*sh) > s.size())
+    {
+        return std::nullopt;
+    }
+    s = s.substr(0, sh->size - sizeof(*sh));
+
+    call_site site{static_cast<level>(sh->level), sh->line, {}, {}, {}, {}};
+
+    auto file = take_string(s);
+    auto function = take_string(s);
+    auto message = take_string(s);
+    if (!file || !function || !message)
+    {
+        return std::nullopt;
+    }
+    site.file = *file;
+    site.function = *function;
+    site.message = *message;
+
+    for (uint32_t i = 0; i < sh->headers; ++i)
+    {
+        auto header = take_string(s);
+        if (!header)
+        {
+            return std::nullopt;
+        }
+        site.headers.push_back(*header);
+    }
+
+    return site;
+}
+
+/** Add the values of a record to its message's fields.
+ *
+ *  @return false if the record doesn't match its call site.
+ */
+static bool add_values(journal_fields& fields, const call_site& site,
+                       std::string_view record)
+{
+    for (auto header : site.headers)
+    {
+        auto f = take<uint16_t>(record);
+        auto value = take_string(record);
+        if (!f || !value)
+        {
+            return false;
+        }
+
+        switch (*f & (signed_val | unsigned_val | str | floating).value)
+        {
+            case signed_val.value:
+            {
+                int64_t v;
+                if (value->size() != sizeof(v))
+                {
+                    return false;
+                }
+                memcpy(&v, value->data(), sizeof(v));
+                fields.add(header, *f, v);
+                break;
+            }
+
+            case unsigned_val.value:
+            {
+                uint64_t v;
+                if (value->size() != sizeof(v))
+                {
+                    return false;
+                }
+                memcpy(&v, value->data(), sizeof(v));
+                fields.add(header, *f, v);
+                break;
+            }
+
+            case str.value:
+            {
+                fields.add(header, *f, *value);
+                break;
+            }
+
+            case floating.value:
+            {
+                double v;
+                if (value->size() != sizeof(v))
+                {
+                    return false;
+                }
+                memcpy(&v, value->data(), sizeof(v));
+                fields.add(header, *f, v);
+                break;
+            }
+
+            default:
+                return false;
+        }
+    }
+
+    return true;
+}
+
+/** Write a field in journal export format. */
+static void write_export_field(std::ostream& o, std::string_view field)
+{
+    if (field.find('\n') == std::string_view::npos)
+    {
+        o << field << '\n';
+        return;
+    }
+
+    // Fields with newlines are written as the name, then the value's
+    // little-endian 64-bit size and the value itself.
+    auto eq = field.find('=');
+    auto value = field.substr(eq + 1);
+    uint64_t size = value.size();
+
+    o << field.substr(0, eq) << '\n';
+    for (size_t i = 0; i < sizeof(size); ++i)
+    {
+        o << static_cast<char>((size >> (8 * i)) & 0xff);
+    }
+    o << value << '\n';
+}
+
+int main(int argc, char* argv[])
+{
+    int arg;
+    bool export_format = false;
+    const char* format = "<%l> %m";
+
+    static struct option long_options[] = {
+        {"help", no_argument, 0, 'h'},
+        {"export", no_argument, 0, 'e'},
+        {"format", required_argument, 0, 'f'},
+        {0, 0, 0, 0}};
+    int option_index = 0;
+
+    while ((arg = getopt_long(argc, argv, "hef:", long_options,
+                              &option_index)) != -1)
+    {
+        switch (arg)
+        {
+            case 'e':
+                export_format = true;
+                break;
+            case 'f':
+                format = optarg;
+                break;
+            case 'h':
+            case '?':
+                std::cerr << usage;
+                return 1;
+        }
+    }
+
+    if (optind + 1 != argc)
+    {
+        std::cerr << usage;
+        return 1;
+    }
+
+    const char* path = argv[optind];
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+    {
+        std::cerr << "Failed to open " << path << ": " << strerror(errno)
+                  << "\n";
+        return 1;
+    }
+
+    trace_reader reader{std::vector<char>(std::istreambuf_iterator<char>(file),
+                                          std::istreambuf_iterator<char>())};
+    if (!reader.valid())
+    {
+        std::cerr << path << " is not an lg2 trace file\n";
+        return 1;
+    }
+
+    auto h = reader.header();
+    output_format output(format);
+    char_buffer line;
+    std::string comm(h.comm.data(), strnlen(h.comm.data(), h.comm.size()));
+
+    auto ok = reader.for_each([&](const trace::record_header& rh,
+                                  std::string_view s, std::string_view record) {
+        auto site = read_site(s);
+        if (!site)
+        {
+            return false;
+        }
+
+        journal_fields fields(site->l, site->file, site->line, site->function,
+                              site->message);
+        if (!add_values(fields, *site, record))
+        {
+            return false;
+        }
+        fields.finish(message_str(site->message.c_str()));
+
+        if (!export_format)
+        {
+            line.clear();
+            output.render(line, site->l, site->file, site->line,
+                          site->function, fields.message());
+            line.push_back('\n');
+            std::cout.write(line.data(), line.size());
+            return true;
+        }
+
+        std::cout << "__REALTIME_TIMESTAMP=" << rh.timestamp << '\n'
+                  << "_PID=" << h.pid << '\n'
+                  << "_COMM=" << comm << '\n';
+        for (size_t i = 0; i < fields.size(); ++i)
+        {
+            write_export_field(std::cout, fields[i]);
+        }
+        std::cout << '\n';
+        return true;
+    });
+
+    if (!ok)
+    {
+        std::cerr << path << " is corrupt\n";
+        return 1;
+    }
+
+    return 0;
+}